@@ -0,0 +1,351 @@
+#include "../Source/PluginProcessor.h"
+
+//==============================================================================
+// Detector engine benchmark: per-channel CPU of the envelope and spectral-flux
+// detectors at common sample rates, checked against
+// SpectralFluxDetector::cpuBudgetPerChannel, plus an onset count on a kick with
+// a quiet hi-hat after every hit (the case the envelope detector misses). A hat
+// counts as found when an onset lands on it that the kicks alone do not trigger;
+// Spectral Flux has to find at least 90% of them, and more than the envelope engine.
+// The envelope engine runs as TransientDesigner runs it (detector plus the
+// attack/sustain followers; eco over whole chunks), at audio rate and in eco
+// (control-rate) detection, on that input and on a dense mix (the same hits over
+// a continuous noise wash).
+// Eco has to be cheaper than audio rate on both inputs, and its largest
+// deviation from the audio-rate detector, relative to the input peak, has to
+// stay within DualEnvelopeDetector::Coefficients::getControlRateErrorBound().
+// The HF Saturation band filter (HFBandFilter::processBlock, as stage 11 runs it
+// per chunk) is timed the same way and has to stay within hfBandBudget of a whole
+// TransientDesigner running with HF Saturation on.
+// Usage: AtakAtakDetectorBenchmark [seconds]
+
+namespace
+{
+    constexpr int numChannels = 2;
+
+    constexpr double hitPeriodSeconds = 0.5;
+    constexpr double hatOffsetSeconds = 0.1;
+
+    // Kick (55 Hz, 200 ms decay) every 500 ms, hi-hat (noise, 30 ms decay) 100 ms after each kick
+    // (or the kicks alone, to tell onsets on a hat from ones on the kick's decay)
+    juce::AudioBuffer<float> makeKickAndHat (double sampleRate, double seconds, int& numOnsets, bool withHats = true)
+    {
+        const int length = (int) (sampleRate * seconds);
+        const int period = (int) (sampleRate * hitPeriodSeconds);
+        const int hatOffset = (int) (sampleRate * hatOffsetSeconds);
+
+        juce::AudioBuffer<float> buffer (numChannels, length);
+        juce::Random random (0x41746b);
+
+        for (int i = 0; i < length; ++i)
+        {
+            const int t = i % period;
+            const float kick = 0.9f * std::exp (-(float) t / (float) (sampleRate * 0.2))
+                                    * std::sin (2.0f * juce::MathConstants<float>::pi * 55.0f * (float) t / (float) sampleRate);
+            const float hat = t < hatOffset || ! withHats ? 0.0f
+                                                          : 0.15f * std::exp (-(float) (t - hatOffset) / (float) (sampleRate * 0.03))
+                                                                  * (random.nextFloat() * 2.0f - 1.0f);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.setSample (ch, i, kick + hat);
+        }
+
+        numOnsets = (withHats ? 2 : 1) * (length / period);
+        return buffer;
+    }
+
+    // Dense mix: the kick and hat over a continuous noise wash at -16 dBFS (cymbals, room)
+    juce::AudioBuffer<float> makeDenseMix (const juce::AudioBuffer<float>& hits)
+    {
+        juce::AudioBuffer<float> buffer (hits);
+        juce::Random random (0x6d6978);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (ch, i, buffer.getSample (ch, i) + 0.16f * (random.nextFloat() * 2.0f - 1.0f));
+
+        return buffer;
+    }
+
+    // One channel of the envelope engine, as in TransientDesigner::detectEnvelope
+    // (audio rate) and TransientDesigner::detectControlRate (eco)
+    struct EnvelopeChannel
+    {
+        DualEnvelopeDetector detector;
+        EnvelopeFollower attackEnvelope, sustainEnvelope;
+
+        void process (const float* x, float* strength, int numSamples,
+                      const DualEnvelopeDetector::Coefficients& dc, const EnvelopeFollower::Coefficients& ec)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                attackEnvelope.process (x[i], ec);
+                sustainEnvelope.process (x[i], ec);
+                strength[i] = detector.process (x[i], dc);
+            }
+        }
+
+        void processControlRate (const float* x, float* strength, int numSamples,
+                                 const DualEnvelopeDetector::Coefficients& dc, const EnvelopeFollower::Coefficients& ec)
+        {
+            for (int done = 0; done < numSamples;)
+            {
+                done += detector.processControlRate (x + done, strength + done, numSamples - done, dc);
+
+                if (detector.isControlStep())
+                {
+                    attackEnvelope.processControlStep (detector.getIntervalLevel(), ec);
+                    sustainEnvelope.processControlStep (detector.getIntervalLevel(), ec);
+                }
+            }
+        }
+    };
+
+    // The plugin's detection chunk (TransientDesigner's fusedChunkSize)
+    constexpr int chunkSize = 256;
+
+    // Largest share of the instance's CPU the HF Saturation band may take
+    constexpr double hfBandBudget = 0.05;
+
+    // An onset from 5 ms before a hat to 50 ms after it (the trigger's hold time), latency removed
+    bool isHatOnset (int position, int latencySamples, double sampleRate)
+    {
+        const double t = std::fmod ((double) (position - latencySamples) / sampleRate, hitPeriodSeconds);
+        return t >= hatOffsetSeconds - 0.005 && t < hatOffsetSeconds + 0.05;
+    }
+
+    struct EngineResult
+    {
+        double realtimeFractionPerChannel = 0.0;
+        int onsets = 0;
+        int hatOnsets = 0;
+    };
+
+    // Runs one engine over the buffer in chunks, detect (channel, input, strength, numSamples);
+    // returns its CPU share and how many onsets it triggered (and how many in a hat's window)
+    template <typename DetectFn>
+    EngineResult run (const juce::AudioBuffer<float>& input, double sampleRate, DetectFn&& detect, int latencySamples = 0)
+    {
+        const int length = input.getNumSamples();
+        std::vector<float> strength ((size_t) length);
+
+        OnsetTrigger trigger;
+        trigger.prepare (sampleRate);
+        trigger.setThreshold (-30.0f);
+        trigger.setHoldTime (50.0f);
+
+        juce::MidiBuffer midi;
+        EngineResult result;
+        juce::int64 ticks = 0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* samples = input.getReadPointer (ch);
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < length; i += chunkSize)
+                detect (ch, samples + i, strength.data() + i, juce::jmin (chunkSize, length - i));
+
+            ticks += juce::Time::getHighResolutionTicks() - start;
+
+            // Onsets are counted outside the timed section
+            if (ch == 0)
+            {
+                trigger.beginBlock (midi, length);
+                trigger.process (strength.data(), length, 0, midi);
+
+                for (const auto metadata : midi)
+                {
+                    if (metadata.getMessage().isNoteOn())
+                    {
+                        ++result.onsets;
+
+                        if (isHatOnset (metadata.samplePosition, latencySamples, sampleRate))
+                            ++result.hatOnsets;
+                    }
+                }
+            }
+        }
+
+        const double seconds = juce::Time::highResolutionTicksToSeconds (ticks);
+        result.realtimeFractionPerChannel = seconds / ((double) length / sampleRate) / numChannels;
+        return result;
+    }
+
+    // Largest |eco - audio-rate| detector output over the input peak, channel 0
+    float measureControlRateError (const juce::AudioBuffer<float>& input, const DualEnvelopeDetector::Coefficients& coeffs)
+    {
+        DualEnvelopeDetector reference, eco;
+        const auto* samples = input.getReadPointer (0);
+        float maxError = 0.0f;
+
+        for (int i = 0; i < input.getNumSamples(); ++i)
+            maxError = juce::jmax (maxError, std::abs (eco.processControlRate (samples[i], coeffs) - reference.process (samples[i], coeffs)));
+
+        return maxError / juce::jmax (1.0e-9f, input.getMagnitude (0, 0, input.getNumSamples()));
+    }
+
+    // Per-channel CPU share of a whole TransientDesigner (defaults, HF Saturation on) in chunk-sized blocks
+    double timeInstance (const juce::AudioBuffer<float>& input, double sampleRate)
+    {
+        const int length = input.getNumSamples();
+
+        TransientDesigner designer;
+        designer.prepare ({ sampleRate, (juce::uint32) chunkSize, (juce::uint32) numChannels });
+        designer.setHFSaturation (50.0f);
+
+        juce::AudioBuffer<float> block (numChannels, chunkSize);
+        juce::int64 ticks = 0;
+
+        for (int i = 0; i < length; i += chunkSize)
+        {
+            const int numSamples = juce::jmin (chunkSize, length - i);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                block.copyFrom (ch, 0, input, ch, i, numSamples);
+
+            juce::dsp::AudioBlock<float> audioBlock (block.getArrayOfWritePointers(), (size_t) numChannels, (size_t) numSamples);
+            juce::dsp::ProcessContextReplacing<float> context (audioBlock);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            designer.process (context);
+            ticks += juce::Time::getHighResolutionTicks() - start;
+        }
+
+        const double seconds = juce::Time::highResolutionTicksToSeconds (ticks);
+        return seconds / ((double) length / sampleRate) / numChannels;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const double seconds = argc > 1 ? juce::jmax (1.0, juce::String (argv[1]).getDoubleValue()) : 20.0;
+    bool withinBudget = true;
+
+    std::cout << "AtakAtak detector benchmark: " << seconds << " s, " << numChannels << " channels, budget "
+              << juce::String (100.0 * SpectralFluxDetector::cpuBudgetPerChannel, 2) << " % of a core per channel" << std::endl;
+
+    for (const double sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+    {
+        int expectedOnsets = 0;
+        const auto input = makeKickAndHat (sampleRate, seconds, expectedOnsets);
+
+        DualEnvelopeDetector::Coefficients coeffs;
+        coeffs.prepare (sampleRate);
+
+        EnvelopeFollower::Coefficients followerCoeffs;
+        followerCoeffs.set_times (1.0f, 100.0f, (float) sampleRate);
+
+        // Audio-rate and eco envelope engines over one input
+        const auto runEnvelope = [&] (const juce::AudioBuffer<float>& buffer, bool controlRate)
+        {
+            std::vector<EnvelopeChannel> envelopes ((size_t) numChannels);
+
+            return run (buffer, sampleRate, [&] (int ch, const float* x, float* strength, int numSamples)
+            {
+                if (controlRate)
+                    envelopes[(size_t) ch].processControlRate (x, strength, numSamples, coeffs, followerCoeffs);
+                else
+                    envelopes[(size_t) ch].process (x, strength, numSamples, coeffs, followerCoeffs);
+            });
+        };
+
+        const auto envelope = runEnvelope (input, false);
+        const auto eco = runEnvelope (input, true);
+
+        const auto dense = makeDenseMix (input);
+        const auto denseEnvelope = runEnvelope (dense, false);
+        const auto denseEco = runEnvelope (dense, true);
+
+        const float ecoError = juce::jmax (measureControlRateError (input, coeffs), measureControlRateError (dense, coeffs));
+        const bool ecoWithinBound = ecoError <= coeffs.getControlRateErrorBound();
+        const bool ecoCheaper = eco.realtimeFractionPerChannel < envelope.realtimeFractionPerChannel
+                                 && denseEco.realtimeFractionPerChannel < denseEnvelope.realtimeFractionPerChannel;
+        const bool ecoOk = ecoWithinBound && ecoCheaper;
+
+        StateArena spectralState;
+        spectralState.allocate (SpectralFluxDetector::getStateBytes (sampleRate, numChannels));
+
+        SpectralFluxDetector spectral;
+        spectral.prepare (sampleRate, numChannels, spectralState);
+
+        const auto runFlux = [&] (const juce::AudioBuffer<float>& buffer)
+        {
+            spectral.reset();
+
+            return run (buffer, sampleRate, [&] (int ch, const float* x, float* strength, int numSamples)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    strength[i] = spectral.process (ch, x[i]);
+            }, spectral.getLookaheadSamples());
+        };
+
+        const auto flux = runFlux (input);
+        const bool ok = flux.realtimeFractionPerChannel <= SpectralFluxDetector::cpuBudgetPerChannel;
+
+        // Hats found: onsets in the hat window beyond those the kicks alone trigger there.
+        // Spectral Flux has to find at least 90% of them, and more than the envelope engine.
+        int numKicks = 0;
+        const auto kicks = makeKickAndHat (sampleRate, seconds, numKicks, false);
+        const int expectedHats = expectedOnsets - numKicks;
+        const int envelopeHats = envelope.hatOnsets - runEnvelope (kicks, false).hatOnsets;
+        const int fluxHats = flux.hatOnsets - runFlux (kicks).hatOnsets;
+        const bool fluxFindsHats = fluxHats * 10 >= expectedHats * 9 && fluxHats > envelopeHats;
+
+        // Stage 11's band split against the instance it runs in (4 kHz: TransientDesigner::hfBandCutoffHz)
+        HFBandFilter::Coefficients hfCoeffs;
+        hfCoeffs.prepare (sampleRate, 4000.0);
+        std::vector<HFBandFilter> hfBands ((size_t) numChannels);
+
+        const auto hfBand = run (input, sampleRate, [&] (int ch, const float* x, float* band, int numSamples)
+        {
+            // The designer's chunk scratch is SIMD aligned; so is this
+            alignas (HFBandFilter::Vec) float chunk[chunkSize];
+            hfBands[(size_t) ch].processBlock (x, chunk, numSamples, hfCoeffs);
+            std::copy (chunk, chunk + numSamples, band);
+        });
+
+        const double instance = timeInstance (input, sampleRate);
+        const double hfShare = hfBand.realtimeFractionPerChannel / juce::jmax (1.0e-12, instance);
+        const bool hfOk = hfShare <= hfBandBudget;
+
+        withinBudget = withinBudget && ok && ecoOk && hfOk && fluxFindsHats;
+
+        const auto print = [&] (const char* name, const EngineResult& result)
+        {
+            std::cout << "  " << juce::String (name).paddedRight (' ', 14)
+                      << juce::String (100.0 * result.realtimeFractionPerChannel, 4).paddedLeft (' ', 9) << " % per channel"
+                      << "   onsets " << result.onsets << " / " << expectedOnsets << std::endl;
+        };
+
+        std::cout << (int) sampleRate << " Hz (spectral lookahead " << spectral.getLookaheadSamples() << " samples)"
+                  << (ok ? "" : "  OVER BUDGET") << std::endl;
+        print ("Envelope", envelope);
+        print ("Envelope (eco)", eco);
+        print ("Spectral Flux", flux);
+
+        std::cout << "  hats found: Envelope " << envelopeHats << ", Spectral Flux " << fluxHats << " / " << expectedHats
+                  << (fluxFindsHats ? "" : "  SPECTRAL FLUX MISSED THE HATS") << std::endl;
+
+        const auto speedup = [] (const EngineResult& reference, const EngineResult& result)
+        {
+            return juce::String (reference.realtimeFractionPerChannel / juce::jmax (1.0e-12, result.realtimeFractionPerChannel), 2) + "x";
+        };
+
+        std::cout << "  dense mix: Envelope " << juce::String (100.0 * denseEnvelope.realtimeFractionPerChannel, 4)
+                  << " %, eco " << juce::String (100.0 * denseEco.realtimeFractionPerChannel, 4) << " % per channel" << std::endl
+                  << "  eco speedup " << speedup (envelope, eco) << " (kick/hat), " << speedup (denseEnvelope, denseEco) << " (dense)"
+                  << (ecoCheaper ? "" : "  NOT CHEAPER") << std::endl
+                  << "  eco error " << juce::String (ecoError, 5) << " of peak (bound "
+                  << juce::String (coeffs.getControlRateErrorBound(), 5) << ", interval " << coeffs.controlInterval << ")"
+                  << (ecoWithinBound ? "" : "  OVER BOUND") << std::endl
+                  << "  HF band " << juce::String (100.0 * hfBand.realtimeFractionPerChannel, 4) << " % per channel, "
+                  << juce::String (100.0 * hfShare, 2) << " % of the instance (" << juce::String (100.0 * instance, 4)
+                  << " % per channel, budget " << juce::String (100.0 * hfBandBudget, 0) << " %)"
+                  << (hfOk ? "" : "  OVER BUDGET") << std::endl;
+    }
+
+    return withinBudget ? 0 : 1;
+}
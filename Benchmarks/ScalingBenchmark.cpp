@@ -0,0 +1,322 @@
+#include "../Source/PluginProcessor.h"
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+//==============================================================================
+// Multi-instance scaling benchmark: N processors (1, 2, 4 ... up to 512) driven
+// block by block from a worker pool, the way a host runs independent tracks of
+// its graph in parallel. Every cycle each instance processes one block; the
+// cycle ends when all of them are done.
+//
+// For each N it reports
+//   - throughput, in instances kept in realtime,
+//   - scaling efficiency: throughput over min(N, threads) isolated instances,
+//   - interference: mean block time in the pool over the isolated block time,
+//     split into the part seen when the same N instances run serially on one
+//     thread (working-set / cache pressure) and the extra the pool adds (shared
+//     state and cache-line contention between cores),
+//   - the p99 and worst cycle against the block deadline.
+//
+// Adaptive Quality is off so every instance does the same work under load.
+// Usage: AtakAtakScalingBenchmark [maxInstances] [seconds] [blockSize] [sampleRate] [threads]
+
+namespace
+{
+    constexpr int numChannels = 2;
+
+    // 4 s drum loop (kick plus noise snare); instances read it at different offsets
+    juce::AudioBuffer<float> makeDrumLoop (double sampleRate)
+    {
+        const int length = (int) (sampleRate * 4.0);
+        const int period = (int) (sampleRate * 0.25);
+
+        juce::AudioBuffer<float> buffer (numChannels, length);
+        juce::Random random (0x41746b);
+
+        for (int i = 0; i < length; ++i)
+        {
+            const int t = i % period;
+            const bool snare = (i / period) % 2 == 1;
+            const float envelope = std::exp (-(float) t / (float) (sampleRate * (snare ? 0.05 : 0.15)));
+            const float tone = snare ? random.nextFloat() * 2.0f - 1.0f
+                                     : std::sin (2.0f * juce::MathConstants<float>::pi * 55.0f * (float) t / (float) sampleRate);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.setSample (ch, i, 0.8f * envelope * tone);
+        }
+
+        return buffer;
+    }
+
+    //==============================================================================
+    // One track of the simulated host. Aligned so the pool's own per-instance
+    // bookkeeping never shares a cache line between threads.
+    struct alignas (64) Instance
+    {
+        std::unique_ptr<AtakAtakAudioProcessor> processor;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+        int readPosition = 0;
+        juce::int64 ticks = 0;
+        juce::int64 blocks = 0;
+    };
+
+    void setParameter (AtakAtakAudioProcessor& processor, const char* id, float value)
+    {
+        auto* param = processor.getAPVTS().getParameter (id);
+        param->setValueNotifyingHost (param->convertTo0to1 (value));
+    }
+
+    std::vector<Instance> createInstances (int count, double sampleRate, int blockSize, int sourceLength)
+    {
+        std::vector<Instance> instances ((size_t) count);
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto& instance = instances[(size_t) i];
+            instance.processor = std::make_unique<AtakAtakAudioProcessor>();
+
+            auto& processor = *instance.processor;
+            setParameter (processor, "adaptiveQuality", 0.0f);
+            setParameter (processor, "attackAmount", 50.0f);
+            setParameter (processor, "sustainAmount", -30.0f);
+            setParameter (processor, "clipperEnabled", 1.0f);
+
+            processor.setPlayConfigDetails (numChannels, numChannels, sampleRate, blockSize);
+            processor.prepareToPlay (sampleRate, blockSize);
+
+            instance.buffer.setSize (numChannels, blockSize);
+            instance.midi.ensureSize (2048);
+            instance.readPosition = (int) ((juce::int64) i * 7919 * blockSize % sourceLength);
+        }
+
+        return instances;
+    }
+
+    // Feeds the next slice of the loop and times processBlock alone
+    void processInstance (Instance& instance, const juce::AudioBuffer<float>& source)
+    {
+        const int blockSize = instance.buffer.getNumSamples();
+        const int sourceLength = source.getNumSamples();
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const int head = juce::jmin (blockSize, sourceLength - instance.readPosition);
+            instance.buffer.copyFrom (ch, 0, source, ch, instance.readPosition, head);
+
+            if (head < blockSize)
+                instance.buffer.copyFrom (ch, head, source, ch, 0, blockSize - head);
+        }
+
+        instance.readPosition = (instance.readPosition + blockSize) % sourceLength;
+        instance.midi.clear();
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        instance.processor->processBlock (instance.buffer, instance.midi);
+        instance.ticks += juce::Time::getHighResolutionTicks() - start;
+        ++instance.blocks;
+    }
+
+    //==============================================================================
+    // Spinning worker pool. The calling thread takes part in every cycle, so a
+    // pool of numThreads runs numThreads - 1 workers. Jobs are handed out through
+    // an atomic index; a cycle returns once every worker has left it.
+    class HostGraph
+    {
+    public:
+        explicit HostGraph (int numThreads)
+        {
+            for (int i = 1; i < numThreads; ++i)
+                workers.emplace_back ([this] { workerLoop(); });
+        }
+
+        ~HostGraph()
+        {
+            quit.store (true, std::memory_order_release);
+
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        template <typename Job>
+        void runCycle (int numJobs, Job& job)
+        {
+            currentJob = [&job] (int index) { job (index); };
+            jobCount = numJobs;
+            nextJob.store (0, std::memory_order_relaxed);
+            finishedWorkers.store (0, std::memory_order_relaxed);
+            generation.fetch_add (1, std::memory_order_release);
+
+            work();
+
+            while (finishedWorkers.load (std::memory_order_acquire) < (int) workers.size())
+                std::this_thread::yield();
+        }
+
+    private:
+        void workerLoop()
+        {
+            int seen = 0;
+
+            while (! quit.load (std::memory_order_acquire))
+            {
+                const int current = generation.load (std::memory_order_acquire);
+
+                if (current == seen)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                seen = current;
+                work();
+                finishedWorkers.fetch_add (1, std::memory_order_release);
+            }
+        }
+
+        void work()
+        {
+            for (int index = nextJob.fetch_add (1, std::memory_order_relaxed); index < jobCount;
+                 index = nextJob.fetch_add (1, std::memory_order_relaxed))
+                currentJob (index);
+        }
+
+        std::vector<std::thread> workers;
+        std::function<void (int)> currentJob;
+        int jobCount = 0;
+
+        alignas (64) std::atomic<int> generation { 0 };
+        alignas (64) std::atomic<int> nextJob { 0 };
+        alignas (64) std::atomic<int> finishedWorkers { 0 };
+        alignas (64) std::atomic<bool> quit { false };
+    };
+
+    //==============================================================================
+    struct RunResult
+    {
+        double wallSeconds = 0.0;
+        double meanBlockMicros = 0.0;
+        double p99CycleMicros = 0.0;
+        double maxCycleMicros = 0.0;
+    };
+
+    // Runs numCycles host cycles over the instances; numThreads == 1 runs them serially
+    RunResult run (std::vector<Instance>& instances, const juce::AudioBuffer<float>& source, int numThreads, int numCycles)
+    {
+        for (auto& instance : instances)
+            instance.ticks = instance.blocks = 0;
+
+        auto job = [&] (int index) { processInstance (instances[(size_t) index], source); };
+        HostGraph graph (numThreads);
+
+        // One untimed cycle so every instance has touched its state
+        graph.runCycle ((int) instances.size(), job);
+
+        std::vector<double> cycleMicros;
+        cycleMicros.reserve ((size_t) numCycles);
+
+        for (auto& instance : instances)
+            instance.ticks = instance.blocks = 0;
+
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int cycle = 0; cycle < numCycles; ++cycle)
+        {
+            const auto cycleStart = juce::Time::getHighResolutionTicks();
+            graph.runCycle ((int) instances.size(), job);
+            cycleMicros.push_back (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - cycleStart) * 1.0e6);
+        }
+
+        RunResult result;
+        result.wallSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+        juce::int64 ticks = 0, blocks = 0;
+
+        for (const auto& instance : instances)
+        {
+            ticks += instance.ticks;
+            blocks += instance.blocks;
+        }
+
+        result.meanBlockMicros = juce::Time::highResolutionTicksToSeconds (ticks) * 1.0e6 / (double) juce::jmax ((juce::int64) 1, blocks);
+
+        std::sort (cycleMicros.begin(), cycleMicros.end());
+        result.p99CycleMicros = cycleMicros[(size_t) juce::jlimit (0, numCycles - 1, (int) std::ceil (0.99 * numCycles) - 1)];
+        result.maxCycleMicros = cycleMicros.back();
+        return result;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const int maxInstances = argc > 1 ? juce::jlimit (1, 512, juce::String (argv[1]).getIntValue()) : 512;
+    const double seconds = argc > 2 ? juce::jmax (0.1, juce::String (argv[2]).getDoubleValue()) : 1.0;
+    const int blockSize = argc > 3 ? juce::jmax (16, juce::String (argv[3]).getIntValue()) : 256;
+    const double sampleRate = argc > 4 ? juce::jmax (8000.0, juce::String (argv[4]).getDoubleValue()) : 48000.0;
+    const int numThreads = argc > 5 ? juce::jmax (1, juce::String (argv[5]).getIntValue()) : juce::SystemStats::getNumCpus();
+
+    const int numCycles = juce::jmax (1, (int) std::ceil (seconds * sampleRate / blockSize));
+    const double deadlineMicros = 1.0e6 * blockSize / sampleRate;
+    const auto source = makeDrumLoop (sampleRate);
+
+    std::cout << "AtakAtak scaling: up to " << maxInstances << " instances, " << numThreads << " threads, "
+              << numCycles << " cycles of " << blockSize << " @ " << sampleRate << " Hz, deadline "
+              << juce::String (deadlineMicros, 1) << " us" << std::endl;
+
+    // Isolated reference: one instance on one thread
+    auto reference = createInstances (1, sampleRate, blockSize, source.getNumSamples());
+    const auto isolated = run (reference, source, 1, numCycles);
+    reference.clear();
+
+    // Realtime instances one core sustains for an instance running alone
+    const double isolatedThroughput = deadlineMicros / isolated.meanBlockMicros;
+
+    std::cout << "isolated: " << juce::String (isolated.meanBlockMicros, 2) << " us per block, "
+              << juce::String (isolatedThroughput, 1) << " instances per core" << std::endl << std::endl;
+
+    std::cout << juce::String ("N").paddedLeft (' ', 5)
+              << juce::String ("realtime").paddedLeft (' ', 10)
+              << juce::String ("efficiency").paddedLeft (' ', 12)
+              << juce::String ("interf.").paddedLeft (' ', 9)
+              << juce::String ("cache").paddedLeft (' ', 8)
+              << juce::String ("contention").paddedLeft (' ', 12)
+              << juce::String ("p99 cycle").paddedLeft (' ', 11)
+              << juce::String ("max cycle").paddedLeft (' ', 11) << std::endl;
+
+    for (int count = 1; count <= maxInstances; count *= 2)
+    {
+        auto instances = createInstances (count, sampleRate, blockSize, source.getNumSamples());
+        const auto serial = run (instances, source, 1, numCycles);
+        const auto parallel = run (instances, source, juce::jmin (numThreads, count), numCycles);
+        instances.clear();
+
+        const double audioSeconds = (double) numCycles * blockSize / sampleRate;
+        const double throughput = count * audioSeconds / parallel.wallSeconds;
+        const double efficiency = throughput / (juce::jmin (numThreads, count) * isolatedThroughput);
+
+        const auto percent = [] (double cycleMicros, double deadline)
+        {
+            return juce::String (100.0 * cycleMicros / deadline, 1) + " %";
+        };
+
+        std::cout << juce::String (count).paddedLeft (' ', 5)
+                  << juce::String (throughput, 1).paddedLeft (' ', 10)
+                  << (juce::String (100.0 * efficiency, 1) + " %").paddedLeft (' ', 12)
+                  << (juce::String (parallel.meanBlockMicros / isolated.meanBlockMicros, 2) + "x").paddedLeft (' ', 9)
+                  << (juce::String (serial.meanBlockMicros / isolated.meanBlockMicros, 2) + "x").paddedLeft (' ', 8)
+                  << (juce::String (parallel.meanBlockMicros / serial.meanBlockMicros, 2) + "x").paddedLeft (' ', 12)
+                  << percent (parallel.p99CycleMicros, deadlineMicros).paddedLeft (' ', 11)
+                  << percent (parallel.maxCycleMicros, deadlineMicros).paddedLeft (' ', 11) << std::endl;
+    }
+
+    std::cout << std::endl
+              << "realtime: instances kept in realtime; efficiency: realtime over min(N, threads) isolated instances" << std::endl
+              << "interf.: pool block time over isolated = cache (serial, N instances) x contention (pool over serial)" << std::endl
+              << "cycle: host cycle time as a share of the block deadline" << std::endl;
+
+    return 0;
+}
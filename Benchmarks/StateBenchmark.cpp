@@ -0,0 +1,137 @@
+#include "../Source/PluginProcessor.h"
+
+//==============================================================================
+// State save/load benchmark: the legacy XML path (as the plugin saved and loaded
+// state before the binary chunk) vs the compact binary chunk.
+// Usage: AtakAtakStateBenchmark [numInstances] [iterations]
+
+namespace
+{
+    double ticksToMicroseconds (juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds (ticks) * 1.0e6;
+    }
+
+    // Mirrors the pre-binary getStateInformation implementation
+    void getLegacyXmlState (AtakAtakAudioProcessor& processor, juce::MemoryBlock& destData)
+    {
+        auto state = processor.getAPVTS().copyState();
+        std::unique_ptr<juce::XmlElement> xml (state.createXml());
+        juce::AudioProcessor::copyXmlToBinary (*xml, destData);
+    }
+
+    // Mirrors the pre-binary setStateInformation implementation (the current one would
+    // take its slower legacy branch via readStateSnapshot)
+    void setLegacyXmlState (AtakAtakAudioProcessor& processor, const juce::MemoryBlock& data)
+    {
+        std::unique_ptr<juce::XmlElement> xml (juce::AudioProcessor::getXmlFromBinary (data.getData(), (int) data.getSize()));
+        auto& parameters = processor.getAPVTS();
+
+        if (xml != nullptr && xml->hasTagName (parameters.state.getType()))
+            parameters.replaceState (juce::ValueTree::fromXml (*xml));
+    }
+
+    void randomiseParameters (AtakAtakAudioProcessor& processor, juce::Random& random)
+    {
+        for (auto* param : processor.getParameters())
+            param->setValueNotifyingHost (random.nextFloat());
+    }
+
+    struct Result
+    {
+        double saveMicros = 0.0;
+        double loadMicros = 0.0;
+        size_t chunkBytes = 0;
+    };
+
+    template <typename SaveFn, typename LoadFn>
+    Result run (std::vector<std::unique_ptr<AtakAtakAudioProcessor>>& instances, int iterations, SaveFn&& save, LoadFn&& load)
+    {
+        Result result;
+        std::vector<juce::MemoryBlock> chunks (instances.size());
+
+        juce::int64 saveTicks = 0, loadTicks = 0;
+
+        for (int it = 0; it < iterations; ++it)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+
+            for (size_t i = 0; i < instances.size(); ++i)
+                save (*instances[i], chunks[i]);
+
+            auto mid = juce::Time::getHighResolutionTicks();
+
+            for (size_t i = 0; i < instances.size(); ++i)
+                load (*instances[i], chunks[i]);
+
+            auto end = juce::Time::getHighResolutionTicks();
+
+            saveTicks += mid - start;
+            loadTicks += end - mid;
+        }
+
+        const auto numCalls = (double) instances.size() * (double) iterations;
+        result.saveMicros = ticksToMicroseconds (saveTicks) / numCalls;
+        result.loadMicros = ticksToMicroseconds (loadTicks) / numCalls;
+        result.chunkBytes = chunks.front().getSize();
+        return result;
+    }
+
+    void print (const char* name, const Result& result)
+    {
+        std::cout << juce::String (name).paddedRight (' ', 8)
+                  << " save " << juce::String (result.saveMicros, 2) << " us"
+                  << "  load " << juce::String (result.loadMicros, 2) << " us"
+                  << "  chunk " << (int) result.chunkBytes << " bytes" << std::endl;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const int numInstances = argc > 1 ? juce::jmax (1, juce::String (argv[1]).getIntValue()) : 256;
+    const int iterations = argc > 2 ? juce::jmax (1, juce::String (argv[2]).getIntValue()) : 20;
+
+    std::vector<std::unique_ptr<AtakAtakAudioProcessor>> instances;
+    juce::Random random (0x41746b);
+
+    for (int i = 0; i < numInstances; ++i)
+    {
+        instances.push_back (std::make_unique<AtakAtakAudioProcessor>());
+        randomiseParameters (*instances.back(), random);
+    }
+
+    // Sanity check: a binary round trip must reproduce every persisted value
+    {
+        juce::MemoryBlock chunk;
+        instances.front()->getStateInformation (chunk);
+
+        auto copy = std::make_unique<AtakAtakAudioProcessor>();
+        copy->setStateInformation (chunk.getData(), (int) chunk.getSize());
+
+        for (auto* id : stateParameterIDs)
+        {
+            const float restored = copy->getAPVTS().getRawParameterValue (id)->load();
+            const float original = instances.front()->getAPVTS().getRawParameterValue (id)->load();
+
+            if (std::abs (restored - original) > 1.0e-4f * juce::jmax (1.0f, std::abs (original)))
+            {
+                std::cout << "Round trip mismatch for " << id << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    std::cout << "AtakAtak state benchmark: " << numInstances << " instances x "
+              << iterations << " iterations (per-instance times)" << std::endl;
+
+    print ("XML", run (instances, iterations,
+                       [] (auto& p, auto& block) { getLegacyXmlState (p, block); },
+                       [] (auto& p, const auto& block) { setLegacyXmlState (p, block); }));
+    print ("Binary", run (instances, iterations,
+                          [] (auto& p, auto& block) { p.getStateInformation (block); },
+                          [] (auto& p, const auto& block) { p.setStateInformation (block.getData(), (int) block.getSize()); }));
+
+    return 0;
+}
@@ -0,0 +1,305 @@
+#include "../Source/PluginProcessor.h"
+
+//==============================================================================
+// Worst-block stress harness: randomised automation (including resetToDefaults,
+// clipper type flips and bypass toggles) against pathological inputs, timing
+// every processBlock call. Reports a per-block time histogram, p50/p99/p99.9/max
+// against the block deadline, and every block whose output was not finite.
+// Usage: AtakAtakStressBenchmark [seconds] [blockSize] [sampleRate] [seed]
+
+namespace
+{
+    enum class InputKind { DRUMS, SILENCE, SQUARE, DENORMALS, NOISE, NAN_BURST, INF_BURST, NUM_KINDS };
+
+    constexpr int numInputKinds = static_cast<int> (InputKind::NUM_KINDS);
+
+    const char* getInputName (InputKind kind)
+    {
+        constexpr const char* names[] = { "drums", "silence", "square", "denormals", "noise", "nan", "inf" };
+        return names[static_cast<int> (kind)];
+    }
+
+    bool isPathologicalNonFinite (InputKind kind)
+    {
+        return kind == InputKind::NAN_BURST || kind == InputKind::INF_BURST;
+    }
+
+    //==============================================================================
+    class InputGenerator
+    {
+    public:
+        InputGenerator (double sr, juce::Random& r) : sampleRate (sr), random (r) {}
+
+        void setKind (InputKind newKind) { kind = newKind; }
+        InputKind getKind() const        { return kind; }
+
+        void fill (juce::AudioBuffer<float>& buffer)
+        {
+            const int numSamples = buffer.getNumSamples();
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float value = next();
+
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                    buffer.setSample (ch, i, value);
+            }
+
+            // Pathological values land on a few random samples of otherwise ordinary audio
+            if (isPathologicalNonFinite (kind))
+            {
+                const float bad = kind == InputKind::NAN_BURST ? std::numeric_limits<float>::quiet_NaN()
+                                                               : (random.nextBool() ? 1.0f : -1.0f) * std::numeric_limits<float>::infinity();
+
+                for (int n = 0; n < 4; ++n)
+                    buffer.setSample (random.nextInt (buffer.getNumChannels()), random.nextInt (numSamples), bad);
+            }
+        }
+
+    private:
+        float next()
+        {
+            ++position;
+
+            switch (kind)
+            {
+                case InputKind::DRUMS:
+                {
+                    // Decaying noise bursts, 4 hits per second
+                    const auto period = (juce::int64) (sampleRate / 4.0);
+                    const float envelope = std::exp (-(float) (position % period) / (float) (sampleRate * 0.05));
+                    return envelope * (random.nextFloat() * 2.0f - 1.0f);
+                }
+
+                case InputKind::SILENCE:
+                    return 0.0f;
+
+                case InputKind::SQUARE:
+                    return (position / (juce::int64) (sampleRate / 200.0)) % 2 == 0 ? 1.0f : -1.0f;
+
+                case InputKind::DENORMALS:
+                    return (random.nextBool() ? 1.0f : -1.0f) * std::numeric_limits<float>::denorm_min() * (float) (1 + random.nextInt (1000));
+
+                case InputKind::NOISE:
+                case InputKind::NAN_BURST:
+                case InputKind::INF_BURST:
+                case InputKind::NUM_KINDS:
+                    break;
+            }
+
+            return random.nextFloat() * 2.0f - 1.0f;
+        }
+
+        double sampleRate;
+        juce::Random& random;
+        InputKind kind = InputKind::DRUMS;
+        juce::int64 position = 0;
+    };
+
+    //==============================================================================
+    class Automation
+    {
+    public:
+        Automation (AtakAtakAudioProcessor& p, juce::Random& r)
+            : random (r),
+              resetToDefaults (p.getAPVTS().getParameter ("resetToDefaults")),
+              clipperType (p.getAPVTS().getParameter ("clipperType")),
+              bypass (p.getAPVTS().getParameter ("bypass"))
+        {
+            for (auto* param : p.getParameters())
+                if (param != resetToDefaults && param != bypass)
+                    continuous.add (param);
+        }
+
+        // Called between blocks, like host automation arriving on the audio thread
+        void step()
+        {
+            // A few ordinary parameter moves most blocks
+            for (int n = random.nextInt (4); --n >= 0;)
+                continuous[random.nextInt (continuous.size())]->setValueNotifyingHost (random.nextFloat());
+
+            if (random.nextFloat() < 0.05f)
+                clipperType->setValueNotifyingHost (random.nextFloat());
+
+            if (random.nextFloat() < 0.02f)
+                bypass->setValueNotifyingHost (bypass->getValue() < 0.5f ? 1.0f : 0.0f);
+
+            if (random.nextFloat() < 0.005f)
+                resetToDefaults->setValueNotifyingHost (1.0f);
+        }
+
+    private:
+        juce::Random& random;
+        juce::AudioProcessorParameter* resetToDefaults;
+        juce::AudioProcessorParameter* clipperType;
+        juce::AudioProcessorParameter* bypass;
+        juce::Array<juce::AudioProcessorParameter*> continuous;
+    };
+
+    //==============================================================================
+    // Log-spaced histogram: 10 buckets per decade from 1 us to 1 s
+    class Histogram
+    {
+    public:
+        void add (double micros)
+        {
+            const int bucket = micros <= 1.0 ? 0 : juce::jmin (numBuckets - 1, (int) (std::log10 (micros) * bucketsPerDecade));
+            ++counts[(size_t) bucket];
+        }
+
+        void print (std::ostream& out) const
+        {
+            const auto peak = *std::max_element (counts.begin(), counts.end());
+
+            for (int i = 0; i < numBuckets; ++i)
+            {
+                if (counts[(size_t) i] == 0)
+                    continue;
+
+                const double lower = std::pow (10.0, (double) i / bucketsPerDecade);
+                const int bar = (int) std::ceil (50.0 * (double) counts[(size_t) i] / (double) peak);
+
+                out << juce::String (lower, 1).paddedLeft (' ', 9) << " us  "
+                    << juce::String (counts[(size_t) i]).paddedLeft (' ', 9) << "  "
+                    << std::string ((size_t) bar, '#') << std::endl;
+            }
+        }
+
+    private:
+        static constexpr int bucketsPerDecade = 10;
+        static constexpr int numBuckets = 6 * bucketsPerDecade + 1;
+        std::array<juce::int64, numBuckets> counts {};
+    };
+
+    double percentile (const std::vector<double>& sorted, double p)
+    {
+        const auto index = (size_t) juce::jlimit (0.0, (double) sorted.size() - 1.0, std::ceil (p * (double) sorted.size()) - 1.0);
+        return sorted[index];
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const double seconds = argc > 1 ? juce::jmax (1.0, juce::String (argv[1]).getDoubleValue()) : 60.0;
+    const int blockSize = argc > 2 ? juce::jmax (1, juce::String (argv[2]).getIntValue()) : 256;
+    const double sampleRate = argc > 3 ? juce::jmax (8000.0, juce::String (argv[3]).getDoubleValue()) : 48000.0;
+    const auto seed = argc > 4 ? juce::String (argv[4]).getLargeIntValue() : (juce::int64) 0x41746b;
+
+    const int numChannels = 2;
+    const auto numBlocks = (size_t) std::ceil (seconds * sampleRate / blockSize);
+    const double deadlineMicros = 1.0e6 * blockSize / sampleRate;
+
+    juce::Random random (seed);
+
+    AtakAtakAudioProcessor processor;
+    processor.setPlayConfigDetails (numChannels, numChannels, sampleRate, blockSize);
+    processor.prepareToPlay (sampleRate, blockSize);
+
+    InputGenerator generator (sampleRate, random);
+    Automation automation (processor, random);
+    Histogram histogram;
+
+    juce::AudioBuffer<float> buffer (numChannels, blockSize);
+    juce::MidiBuffer midi;
+    midi.ensureSize (2048);
+
+    std::vector<double> blockMicros;
+    blockMicros.reserve (numBlocks);
+
+    std::array<juce::int64, numInputKinds> blocksPerKind {}, nonFiniteBlocksPerKind {};
+    juce::int64 nonFiniteSamples = 0;
+    juce::int64 firstNonFiniteBlock = -1;
+
+    // Finite input going non-finite with no NaN / inf fed yet can only come from the DSP itself
+    juce::int64 nonFiniteFromCleanState = 0;
+    bool nonFiniteInputSeen = false;
+
+    std::cout << "AtakAtak stress: " << (juce::int64) numBlocks << " blocks of " << blockSize << " @ "
+              << sampleRate << " Hz, seed " << seed << ", deadline " << juce::String (deadlineMicros, 1) << " us" << std::endl;
+
+    for (size_t block = 0; block < numBlocks; ++block)
+    {
+        // Input regime changes every ~100 ms on average
+        if (random.nextFloat() < (float) blockSize / (float) (0.1 * sampleRate))
+            generator.setKind (static_cast<InputKind> (random.nextInt (numInputKinds)));
+
+        generator.fill (buffer);
+        automation.step();
+        midi.clear();
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock (buffer, midi);
+        const auto end = juce::Time::getHighResolutionTicks();
+
+        const double micros = juce::Time::highResolutionTicksToSeconds (end - start) * 1.0e6;
+        blockMicros.push_back (micros);
+        histogram.add (micros);
+
+        const auto kind = static_cast<size_t> (generator.getKind());
+        const bool finiteInput = ! isPathologicalNonFinite (generator.getKind());
+        ++blocksPerKind[kind];
+
+        juce::int64 blockNonFinite = 0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                if (! std::isfinite (buffer.getSample (ch, i)))
+                    ++blockNonFinite;
+
+        if (blockNonFinite > 0)
+        {
+            nonFiniteSamples += blockNonFinite;
+            ++nonFiniteBlocksPerKind[kind];
+
+            if (firstNonFiniteBlock < 0)
+                firstNonFiniteBlock = (juce::int64) block;
+
+            if (finiteInput && ! nonFiniteInputSeen)
+                ++nonFiniteFromCleanState;
+        }
+
+        nonFiniteInputSeen = nonFiniteInputSeen || ! finiteInput;
+    }
+
+    std::vector<double> sorted (blockMicros);
+    std::sort (sorted.begin(), sorted.end());
+
+    std::cout << std::endl << "Block time histogram" << std::endl;
+    histogram.print (std::cout);
+
+    const auto report = [&] (const char* name, double micros)
+    {
+        std::cout << juce::String (name).paddedRight (' ', 6) << juce::String (micros, 2).paddedLeft (' ', 10) << " us  "
+                  << juce::String (100.0 * micros / deadlineMicros, 2).paddedLeft (' ', 7) << " % of deadline" << std::endl;
+    };
+
+    std::cout << std::endl;
+    report ("p50", percentile (sorted, 0.5));
+    report ("p99", percentile (sorted, 0.99));
+    report ("p99.9", percentile (sorted, 0.999));
+    report ("max", sorted.back());
+
+    const auto overruns = std::count_if (sorted.begin(), sorted.end(), [=] (double t) { return t > deadlineMicros; });
+    std::cout << "blocks over deadline: " << (juce::int64) overruns << std::endl;
+
+    std::cout << std::endl << "Non-finite output blocks by input" << std::endl;
+
+    for (int k = 0; k < numInputKinds; ++k)
+        std::cout << "  " << juce::String (getInputName (static_cast<InputKind> (k))).paddedRight (' ', 10)
+                  << juce::String (nonFiniteBlocksPerKind[(size_t) k]).paddedLeft (' ', 9) << " / "
+                  << blocksPerKind[(size_t) k] << std::endl;
+
+    std::cout << "non-finite samples: " << nonFiniteSamples;
+
+    if (firstNonFiniteBlock >= 0)
+        std::cout << " (first at block " << firstNonFiniteBlock << ")";
+
+    std::cout << std::endl << "finite input, non-finite output before any NaN / inf input: "
+              << nonFiniteFromCleanState << " blocks" << std::endl;
+
+    // Fails when finite input produced non-finite output without an earlier NaN / inf to blame
+    // (processBlock replaces non-finite input with silence, so the other rows should stay at 0 too)
+    return nonFiniteFromCleanState == 0 ? 0 : 1;
+}
@@ -0,0 +1,512 @@
+#pragma once
+
+#include "../JUCE/modules/juce_dsp/juce_dsp.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// PeakEater-inspired Clipper Types (optimized for drums)
+enum class ClipperType {
+    HARD = 0,
+    QUINTIC,
+    CUBIC,
+    TANGENT,
+    ALGEBRAIC,
+    ARCTANGENT
+};
+
+// Antiderivative anti-aliasing order for the clipper stage
+enum class ClipperAntialiasing {
+    OFF = 0,
+    ADAA1,
+    ADAA2
+};
+
+//==============================================================================
+// Clipper curves on the ceiling-normalised input u = x * drive / ceiling.
+// Every curve is the identity for |u| <= 1 and clips above it exactly like
+// the block kernels in ClipperKernels. F1/F2 are the first and second
+// antiderivatives of the whole odd curve (identity region included), in
+// closed form, as needed by the ADAA clipper. Evaluated in double because the
+// polynomial curves reach u^7 at high drive.
+namespace ClipperCurves
+{
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double tangentScale = 0.7;
+    constexpr double arctangentScale = pi * 0.5;
+
+    // Clipped magnitude for u > 1
+    inline double shape (ClipperType type, double u)
+    {
+        switch (type)
+        {
+            case ClipperType::HARD:       return 1.0;
+            case ClipperType::QUINTIC:    return std::min (1.0, u - std::pow (u, 5.0) / 5.0);
+            case ClipperType::CUBIC:      return std::min (1.0, u - u * u * u / 3.0);
+            case ClipperType::TANGENT:    return std::tanh (u * tangentScale) / std::tanh (tangentScale);
+            case ClipperType::ALGEBRAIC:  return u / std::sqrt (1.0 + u * u);
+            case ClipperType::ARCTANGENT: return (2.0 / pi) * std::atan (u * arctangentScale);
+        }
+
+        return 1.0;
+    }
+
+    // ln cosh integrated from 0 to x (x >= 0). Li2(-e^-2x) converges quickly
+    // because the curve only needs x >= tangentScale, i.e. |e^-2x| < 0.25.
+    inline double integralLogCosh (double x)
+    {
+        const double z = -std::exp (-2.0 * x);
+        double term = z, li2 = 0.0;
+
+        for (int k = 1; k <= 16; ++k)
+        {
+            li2 += term / (double) (k * k);
+            term *= z;
+        }
+
+        return 0.5 * x * x - x * std::log (2.0) + pi * pi / 24.0 + 0.5 * li2;
+    }
+
+    // Antiderivative of the arctangent curve's shape (without the 2/pi factor)
+    inline double arctangentH (double t)
+    {
+        const double b = arctangentScale;
+        return t * std::atan (b * t) - std::log (1.0 + b * b * t * t) / (2.0 * b);
+    }
+
+    // Antiderivative of arctangentH
+    inline double arctangentJ (double t)
+    {
+        const double b = arctangentScale;
+        const double bt = b * t;
+        return ((bt * bt + 1.0) * std::atan (bt) - bt) / (2.0 * b * b)
+             - (t * std::log (1.0 + bt * bt) - 2.0 * t + (2.0 / b) * std::atan (bt)) / (2.0 * b);
+    }
+
+    // Integral of shape from 1 to u (u > 1)
+    inline double shapeIntegral (ClipperType type, double u)
+    {
+        switch (type)
+        {
+            case ClipperType::HARD:
+                return u - 1.0;
+
+            case ClipperType::QUINTIC: // min() never engages above the ceiling
+                return (u * u / 2.0 - std::pow (u, 6.0) / 30.0) - (1.0 / 2.0 - 1.0 / 30.0);
+
+            case ClipperType::CUBIC:
+                return (u * u / 2.0 - std::pow (u, 4.0) / 12.0) - (1.0 / 2.0 - 1.0 / 12.0);
+
+            case ClipperType::TANGENT:
+            {
+                const double a = tangentScale;
+                return (std::log (std::cosh (a * u)) - std::log (std::cosh (a))) / (a * std::tanh (a));
+            }
+
+            case ClipperType::ALGEBRAIC:
+                return std::sqrt (1.0 + u * u) - std::sqrt (2.0);
+
+            case ClipperType::ARCTANGENT:
+                return (2.0 / pi) * (arctangentH (u) - arctangentH (1.0));
+        }
+
+        return 0.0;
+    }
+
+    // Double integral of shape from 1 to u (u > 1)
+    inline double shapeIntegral2 (ClipperType type, double u)
+    {
+        const double d = u - 1.0;
+
+        switch (type)
+        {
+            case ClipperType::HARD:
+                return 0.5 * d * d;
+
+            case ClipperType::QUINTIC:
+                return (u * u * u / 6.0 - std::pow (u, 7.0) / 210.0) - (1.0 / 6.0 - 1.0 / 210.0)
+                     - (1.0 / 2.0 - 1.0 / 30.0) * d;
+
+            case ClipperType::CUBIC:
+                return (u * u * u / 6.0 - std::pow (u, 5.0) / 60.0) - (1.0 / 6.0 - 1.0 / 60.0)
+                     - (1.0 / 2.0 - 1.0 / 12.0) * d;
+
+            case ClipperType::TANGENT:
+            {
+                const double a = tangentScale;
+                return ((integralLogCosh (a * u) - integralLogCosh (a)) / a - std::log (std::cosh (a)) * d)
+                     / (a * std::tanh (a));
+            }
+
+            case ClipperType::ALGEBRAIC:
+                return 0.5 * (u * std::sqrt (1.0 + u * u) + std::asinh (u))
+                     - 0.5 * (std::sqrt (2.0) + std::asinh (1.0))
+                     - std::sqrt (2.0) * d;
+
+            case ClipperType::ARCTANGENT:
+                return (2.0 / pi) * (arctangentJ (u) - arctangentJ (1.0) - arctangentH (1.0) * d);
+        }
+
+        return 0.0;
+    }
+
+    // Full odd curve
+    inline double f (ClipperType type, double x)
+    {
+        const double u = std::abs (x);
+        // Not copysign: the polynomial curves go negative at high drive, like the kernels
+        return u <= 1.0 ? x : (x < 0.0 ? -shape (type, u) : shape (type, u));
+    }
+
+    // First antiderivative (even)
+    inline double F1 (ClipperType type, double x)
+    {
+        const double u = std::abs (x);
+        return u <= 1.0 ? 0.5 * x * x : 0.5 + shapeIntegral (type, u);
+    }
+
+    // Second antiderivative (odd)
+    inline double F2 (ClipperType type, double x)
+    {
+        const double u = std::abs (x);
+
+        if (u <= 1.0)
+            return x * x * x / 6.0;
+
+        const double v = 1.0 / 6.0 + 0.5 * (u - 1.0) + shapeIntegral2 (type, u);
+        return x < 0.0 ? -v : v;
+    }
+}
+
+//==============================================================================
+// PeakEater-style block clipper: drive is input gain, ceiling is the threshold.
+// One kernel per ClipperType, so there is no per-sample curve switch and no
+// early-out at the ceiling: every lane evaluates the curve and a mask selects
+// the passthrough. Every curve runs on juce::dsp::SIMDRegister (4 floats with
+// SSE/NEON, 8 with AVX). SIMDRegister has no division, sqrt or exp, so the
+// transcendental curves are built from multiply/add: Newton reciprocals and
+// reciprocal square roots, exp by repeated squaring and a reduced atan series
+// (within 1e-6 of the ceiling of the std:: curves used by the scalar head/tail).
+namespace ClipperKernels
+{
+    using Vec = juce::dsp::SIMDRegister<float>;
+    using Bits = juce::dsp::SIMDRegister<uint32_t>;
+
+    //==============================================================================
+    // Approximations for positive, finite lanes
+
+    inline Bits toBits(Vec x) { Bits b; std::memcpy(&b, &x, sizeof(b)); return b; }
+    inline Vec fromBits(Bits b) { Vec x; std::memcpy(&x, &b, sizeof(x)); return x; }
+
+    // 1 / a: exponent-negating seed (12% error) and three Newton steps
+    inline Vec reciprocal(Vec a)
+    {
+        const Vec two = Vec::expand(2.0f);
+        Vec r = fromBits(Bits::expand(0x7ef311c3u) - toBits(a));
+
+        for (int step = 0; step < 3; ++step)
+            r = r * (two - a * r);
+
+        return r;
+    }
+
+    // 1 / sqrt(b) for b in [0.5, 1]: quadratic seed (0.4% error) and two Newton steps
+    inline Vec reciprocalSqrtHalfToOne(Vec b)
+    {
+        const Vec half = Vec::expand(0.5f), threeHalves = Vec::expand(1.5f);
+        Vec r = Vec::expand(2.2255207f) + b * (Vec::expand(0.8200445f) * b - Vec::expand(2.0427935f));
+
+        for (int step = 0; step < 2; ++step)
+            r = r * (threeHalves - half * b * r * r);
+
+        return r;
+    }
+
+    // e^x for x in [0, 18]: Taylor series at x / 16 (11th order), squared four times
+    inline Vec expUpTo18(Vec x)
+    {
+        const Vec z = x * Vec::expand(1.0f / 16.0f);
+        Vec e = Vec::expand(1.0f / 39916800.0f);
+
+        for (const float c : { 1.0f / 3628800.0f, 1.0f / 362880.0f, 1.0f / 40320.0f, 1.0f / 5040.0f, 1.0f / 720.0f,
+                               1.0f / 120.0f, 1.0f / 24.0f, 1.0f / 6.0f, 0.5f, 1.0f, 1.0f })
+            e = e * z + Vec::expand(c);
+
+        for (int square = 0; square < 4; ++square)
+            e = e * e;
+
+        return e;
+    }
+
+    // atan(1 / v) for v >= 1. Below 1 / tan(pi/8) it is pi/4 + atan((1 - v) / (1 + v)),
+    // leaving |s| <= tan(pi/8) for the odd series (error < 2e-8 at 15th order)
+    inline Vec atanOfReciprocal(Vec v)
+    {
+        const auto reduce = Vec::lessThan(v, Vec::expand(2.41421356f));
+        const Vec one = Vec::expand(1.0f);
+        const Vec numerator = ((one - v) & reduce) + (one & ~reduce);
+        const Vec s = numerator * reciprocal(v + (one & reduce));
+        const Vec offset = Vec::expand((float) (ClipperCurves::pi * 0.25)) & reduce;
+
+        const Vec s2 = s * s;
+        Vec series = Vec::expand(-1.0f / 15.0f);
+
+        for (const float c : { 1.0f / 13.0f, -1.0f / 11.0f, 1.0f / 9.0f, -1.0f / 7.0f, 1.0f / 5.0f, -1.0f / 3.0f, 1.0f })
+            series = series * s2 + Vec::expand(c);
+
+        return offset + s * series;
+    }
+
+    //==============================================================================
+    template <ClipperType type> struct Curve;
+
+    template <> struct Curve<ClipperType::HARD>
+    {
+        static float shape(float) { return 1.0f; }
+        static Vec shape(Vec) { return Vec::expand(1.0f); }
+    };
+
+    template <> struct Curve<ClipperType::QUINTIC> // Great for drums - smooth but punchy
+    {
+        static float shape(float u)
+        {
+            const float u2 = u * u;
+            return std::min(1.0f, u - (1.0f / 5.0f) * u2 * u2 * u);
+        }
+
+        static Vec shape(Vec u)
+        {
+            const Vec u2 = u * u;
+            return Vec::min(Vec::expand(1.0f), u - Vec::expand(1.0f / 5.0f) * u2 * u2 * u);
+        }
+    };
+
+    template <> struct Curve<ClipperType::CUBIC> // Warm saturation for cymbals
+    {
+        static float shape(float u)
+        {
+            return std::min(1.0f, u - (1.0f / 3.0f) * u * u * u);
+        }
+
+        static Vec shape(Vec u)
+        {
+            return Vec::min(Vec::expand(1.0f), u - Vec::expand(1.0f / 3.0f) * u * u * u);
+        }
+    };
+
+    // The vector shapes are only selected above the ceiling (u > 1); lanes below it
+    // are clamped into the approximations' range and discarded by the mask
+
+    template <> struct Curve<ClipperType::TANGENT> // Musical saturation
+    {
+        static float shape(float u) { return std::tanh(u * 0.7f) / std::tanh(0.7f); }
+
+        // tanh(y) = 1 - 2 / (e^2y + 1); tanh(9) rounds to 1 in float
+        static Vec shape(Vec u)
+        {
+            const Vec y = Vec::min(Vec::expand(9.0f), u * Vec::expand(0.7f));
+            const Vec tanh = Vec::expand(1.0f) - Vec::expand(2.0f) * reciprocal(expUpTo18(y + y) + Vec::expand(1.0f));
+            return tanh * Vec::expand(1.0f / std::tanh(0.7f));
+        }
+    };
+
+    template <> struct Curve<ClipperType::ALGEBRAIC> // Smooth limiting
+    {
+        static float shape(float u) { return u / std::sqrt(1.0f + u * u); }
+
+        // sqrt(b) with b = u^2 / (1 + u^2) in [0.5, 1) for u >= 1
+        static Vec shape(Vec u)
+        {
+            const Vec u2 = Vec::min(Vec::expand(1.0e8f), Vec::max(Vec::expand(1.0f), u * u));
+            const Vec b = u2 * reciprocal(Vec::expand(1.0f) + u2);
+            return b * reciprocalSqrtHalfToOne(b);
+        }
+    };
+
+    template <> struct Curve<ClipperType::ARCTANGENT> // Subtle enhancement
+    {
+        static float shape(float u)
+        {
+            constexpr float twoOverPi = (float) (2.0 / ClipperCurves::pi);
+            constexpr float halfPi = (float) (ClipperCurves::pi * 0.5);
+            return twoOverPi * std::atan(u * halfPi);
+        }
+
+        // atan(v) = pi/2 - atan(1 / v) for v = u * pi/2 >= pi/2
+        static Vec shape(Vec u)
+        {
+            constexpr float halfPi = (float) (ClipperCurves::pi * 0.5);
+            const Vec v = Vec::min(Vec::expand(1.0e8f), Vec::max(Vec::expand(halfPi), u * Vec::expand(halfPi)));
+            return Vec::expand(1.0f) - Vec::expand((float) (2.0 / ClipperCurves::pi)) * atanOfReciprocal(v);
+        }
+    };
+
+    template <ClipperType type>
+    inline float processSample(float input, float ceiling, float drive, float invCeiling)
+    {
+        const float driven = input * drive;
+        const float magnitude = std::abs(driven);
+
+        // Sign is applied by multiplication: the polynomial curves can go negative
+        const float sign = driven < 0.0f ? -1.0f : 1.0f;
+        const float clipped = sign * Curve<type>::shape(magnitude * invCeiling) * ceiling;
+
+        return magnitude <= ceiling ? driven : clipped;
+    }
+
+    template <ClipperType type>
+    void process(float* data, int numSamples, float ceiling, float drive)
+    {
+        const float invCeiling = 1.0f / ceiling;
+        int i = 0;
+
+        // Scalar head up to the first aligned sample, SIMD body, scalar tail
+        const int head = std::min(numSamples, static_cast<int>(Vec::getNextSIMDAlignedPtr(data) - data));
+
+        for (; i < head; ++i)
+            data[i] = processSample<type>(data[i], ceiling, drive, invCeiling);
+
+        const Vec driveV = Vec::expand(drive);
+        const Vec ceilingV = Vec::expand(ceiling);
+        const Vec invCeilingV = Vec::expand(invCeiling);
+        const Vec zero = Vec::expand(0.0f), one = Vec::expand(1.0f), two = Vec::expand(2.0f);
+        constexpr int width = static_cast<int>(Vec::size());
+
+        for (; i + width <= numSamples; i += width)
+        {
+            const Vec driven = Vec::fromRawArray(data + i) * driveV;
+            const Vec magnitude = Vec::max(driven, zero - driven);
+
+            const Vec sign = one - (two & Vec::lessThan(driven, zero));
+            const Vec clipped = sign * Curve<type>::shape(magnitude * invCeilingV) * ceilingV;
+
+            // Masked select: exactly one side survives, the other is +0
+            const auto underCeiling = Vec::lessThanOrEqual(magnitude, ceilingV);
+            const Vec result = (driven & underCeiling) + (clipped & ~underCeiling);
+
+            result.copyToRawArray(data + i);
+        }
+
+        for (; i < numSamples; ++i)
+            data[i] = processSample<type>(data[i], ceiling, drive, invCeiling);
+    }
+
+    // Runtime dispatch, once per block
+    inline void process(ClipperType type, float* data, int numSamples, float ceiling, float drive)
+    {
+        switch (type)
+        {
+            case ClipperType::HARD:       process<ClipperType::HARD>(data, numSamples, ceiling, drive); break;
+            case ClipperType::QUINTIC:    process<ClipperType::QUINTIC>(data, numSamples, ceiling, drive); break;
+            case ClipperType::CUBIC:      process<ClipperType::CUBIC>(data, numSamples, ceiling, drive); break;
+            case ClipperType::TANGENT:    process<ClipperType::TANGENT>(data, numSamples, ceiling, drive); break;
+            case ClipperType::ALGEBRAIC:  process<ClipperType::ALGEBRAIC>(data, numSamples, ceiling, drive); break;
+            case ClipperType::ARCTANGENT: process<ClipperType::ARCTANGENT>(data, numSamples, ceiling, drive); break;
+        }
+    }
+}
+
+//==============================================================================
+// Antiderivative anti-aliased clipper (Parker, Zavalishin & Le Bihan, DAFx-16).
+// One instance per channel. First order adds half a sample of delay, second
+// order one sample. Near-equal consecutive inputs fall back to evaluating the
+// curve (or F1) at the midpoint to avoid the ill-conditioned divisions.
+class ADAAClipper
+{
+public:
+    void reset()
+    {
+        x1 = x2 = 0.0;
+        d1Prev = 0.0;
+        cacheKey = -1;
+    }
+
+    float process(float input, float ceiling, float drive, ClipperType type, ClipperAntialiasing order)
+    {
+        const double x = (double) input * drive / ceiling;
+
+        const int key = (int) type * 4 + (int) order;
+
+        if (cacheKey != key)
+        {
+            // Curve or order changed: refresh the cached antiderivatives of the history
+            cacheKey = key;
+            F1x1 = ClipperCurves::F1 (type, x1);
+            F2x1 = ClipperCurves::F2 (type, x1);
+            d1Prev = firstDifference (type, x1, x2, F2x1, ClipperCurves::F2 (type, x2));
+        }
+
+        const double y = order == ClipperAntialiasing::ADAA2 ? processSecondOrder (x, type)
+                                                             : processFirstOrder (x, type);
+        return (float) (y * ceiling);
+    }
+
+private:
+    double x1 = 0.0, x2 = 0.0;
+    double F1x1 = 0.0, F2x1 = 0.0;
+    double d1Prev = 0.0;
+    int cacheKey = -1;
+
+    static double tolerance (double a, double b)
+    {
+        return 1.0e-5 * std::max (1.0, std::max (std::abs (a), std::abs (b)));
+    }
+
+    // (F2(a) - F2(b)) / (a - b), falling back to F1 at the midpoint
+    static double firstDifference (ClipperType type, double a, double b, double F2a, double F2b)
+    {
+        const double diff = a - b;
+
+        if (std::abs (diff) < tolerance (a, b))
+            return ClipperCurves::F1 (type, 0.5 * (a + b));
+
+        return (F2a - F2b) / diff;
+    }
+
+    double processFirstOrder (double x, ClipperType type)
+    {
+        const double F1x = ClipperCurves::F1 (type, x);
+        const double diff = x - x1;
+
+        const double y = std::abs (diff) < tolerance (x, x1) ? ClipperCurves::f (type, 0.5 * (x + x1))
+                                                             : (F1x - F1x1) / diff;
+
+        // x2 is kept so a switch to second order can rebuild its history
+        x2 = x1;
+        x1 = x;
+        F1x1 = F1x;
+        return y;
+    }
+
+    double processSecondOrder (double x, ClipperType type)
+    {
+        const double F2x = ClipperCurves::F2 (type, x);
+        const double d1 = firstDifference (type, x, x1, F2x, F2x1);
+        const double diff = x - x2;
+
+        double y;
+
+        if (std::abs (diff) < tolerance (x, x2))
+        {
+            const double xBar = 0.5 * (x + x2);
+            const double delta = xBar - x1;
+
+            if (std::abs (delta) < tolerance (xBar, x1))
+                y = ClipperCurves::f (type, 0.5 * (xBar + x1));
+            else
+                y = (2.0 / delta) * (ClipperCurves::F1 (type, xBar)
+                                      + (F2x1 - ClipperCurves::F2 (type, xBar)) / delta);
+        }
+        else
+        {
+            y = (2.0 / diff) * (d1 - d1Prev);
+        }
+
+        d1Prev = d1;
+        x2 = x1;
+        x1 = x;
+        F1x1 = ClipperCurves::F1 (type, x);
+        F2x1 = F2x;
+        return y;
+    }
+};
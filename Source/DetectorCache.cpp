@@ -0,0 +1,111 @@
+#include "DetectorCache.h"
+
+//==============================================================================
+bool DetectorEnvelopeCache::create (const juce::File& cacheFile, const juce::AudioBuffer<float>& input,
+                                    double sampleRate, juce::int64 sourceId)
+{
+    juce::TemporaryFile temp (cacheFile);
+
+    {
+        juce::FileOutputStream out (temp.getFile());
+
+        if (! out.openedOk())
+            return false;
+
+        const int numChannels = input.getNumChannels();
+        const int length = input.getNumSamples();
+
+        out.writeInt (cacheMagic);
+        out.writeInt (cacheVersion);
+        out.writeInt (detectorVersion);
+        out.writeInt (numChannels);
+        out.writeInt64 ((juce::int64) length);
+        out.writeDouble (sampleRate);
+        out.writeInt64 (sourceId);
+
+        while (out.getPosition() < headerSize)
+            out.writeByte (0);
+
+        DualEnvelopeDetector::Coefficients coeffs;
+        coeffs.prepare (sampleRate);
+
+        // One block of envelope at a time, so memory stays flat for long files
+        std::array<float, 4096> envelope;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            DualEnvelopeDetector detector;
+            const auto* samples = input.getReadPointer (ch);
+
+            for (int start = 0; start < length; start += (int) envelope.size())
+            {
+                const int n = juce::jmin ((int) envelope.size(), length - start);
+
+                for (int i = 0; i < n; ++i)
+                    envelope[(size_t) i] = detector.process (samples[start + i], coeffs);
+
+                if (! out.write (envelope.data(), sizeof (float) * (size_t) n))
+                    return false;
+            }
+        }
+
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+bool DetectorEnvelopeCache::open (const juce::File& cacheFile, double sampleRate, juce::int64 sourceId)
+{
+    mapping.reset();
+    channels.clear();
+    numSamples = 0;
+
+    if (! cacheFile.existsAsFile())
+        return false;
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile> (cacheFile, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*> (mapped->getData());
+
+    if (data == nullptr || mapped->getSize() < (size_t) headerSize)
+        return false;
+
+    const int numChannels = (int) juce::ByteOrder::littleEndianInt (data + 12);
+    const auto length = (juce::int64) juce::ByteOrder::littleEndianInt64 (data + 16);
+
+    const auto rateBits = juce::ByteOrder::littleEndianInt64 (data + 24);
+    double storedRate = 0.0;
+    std::memcpy (&storedRate, &rateBits, sizeof (double));
+
+    if ((juce::int32) juce::ByteOrder::littleEndianInt (data) != cacheMagic
+        || (juce::int32) juce::ByteOrder::littleEndianInt (data + 4) != cacheVersion
+        || (juce::int32) juce::ByteOrder::littleEndianInt (data + 8) != detectorVersion
+        || (juce::int64) juce::ByteOrder::littleEndianInt64 (data + 32) != sourceId
+        || storedRate != sampleRate || numChannels <= 0 || length < 0)
+        return false;
+
+    if (mapped->getSize() < (size_t) headerSize + (size_t) numChannels * (size_t) length * sizeof (float))
+        return false;
+
+    const auto* envelope = reinterpret_cast<const float*> (data + headerSize);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        channels.push_back (envelope + (size_t) ch * (size_t) length);
+
+    numSamples = length;
+    mapping = std::move (mapped);
+    return true;
+}
+
+juce::File DetectorEnvelopeCache::getCacheFileFor (const juce::File& audioFile)
+{
+    return audioFile.getSiblingFile (audioFile.getFileName() + ".atakenv");
+}
+
+juce::int64 DetectorEnvelopeCache::getSourceId (const juce::File& audioFile)
+{
+    return audioFile.getSize() * 1000003 + audioFile.getLastModificationTime().toMilliseconds();
+}
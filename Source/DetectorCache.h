@@ -0,0 +1,54 @@
+#pragma once
+
+#include "PluginProcessor.h"
+
+//==============================================================================
+// Offline analysis cache for the transient detector. DualEnvelopeDetector only
+// depends on the input audio and the sample rate, so its output can be computed
+// once per file and reused by every render with different shaping settings.
+//
+// The detector is homogeneous in its input (peak + one-pole filters), so the
+// envelope is stored at unity input gain and scaled by the input gain at render
+// time - exact for a steady gain, approximate while the gain ramps.
+//
+// File layout (little-endian): 64-byte header - magic "AtkE", format version,
+// detector version, channel count, sample count (int64), sample rate (double),
+// source id (int64), zero padding - followed by one float per sample, planar by
+// channel. The file is memory-mapped read-only, so any number of renders can
+// share one mapping.
+class DetectorEnvelopeCache
+{
+public:
+    DetectorEnvelopeCache() = default;
+
+    // Runs the detector over input and writes the cache atomically (temp file + rename)
+    static bool create (const juce::File& cacheFile, const juce::AudioBuffer<float>& input,
+                        double sampleRate, juce::int64 sourceId);
+
+    // Maps an existing cache; false if it is missing, corrupt or was built from other audio
+    bool open (const juce::File& cacheFile, double sampleRate, juce::int64 sourceId);
+
+    bool isOpen() const                         { return mapping != nullptr; }
+    int getNumChannels() const                  { return static_cast<int> (channels.size()); }
+    juce::int64 getNumSamples() const           { return numSamples; }
+    const float* const* getChannels() const     { return channels.data(); }
+
+    // <file>.atakenv next to the audio file
+    static juce::File getCacheFileFor (const juce::File& audioFile);
+
+    // Cheap identity of an audio file (size + modification time)
+    static juce::int64 getSourceId (const juce::File& audioFile);
+
+private:
+    static constexpr juce::int32 cacheMagic = 0x456b7441; // "AtkE" little-endian
+    static constexpr juce::int32 cacheVersion = 1;
+    // Bump when DualEnvelopeDetector's maths or time constants change
+    static constexpr juce::int32 detectorVersion = 1;
+    static constexpr int headerSize = 64;
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    std::vector<const float*> channels;
+    juce::int64 numSamples = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DetectorEnvelopeCache)
+};
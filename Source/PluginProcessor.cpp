@@ -1,5 +1,7 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "PresetBank.h"
+#include "DetectorCache.h"
 
 //==============================================================================
 AtakAtakAudioProcessor::AtakAtakAudioProcessor()
@@ -15,14 +17,33 @@ AtakAtakAudioProcessor::AtakAtakAudioProcessor()
        parameters(*this, nullptr, "Parameters", createParameterLayout())
 #endif
 {
-    // Initialize DSP processors
-    inputGainProcessor = std::make_unique<GainProcessor>();
-    outputGainProcessor = std::make_unique<GainProcessor>();
-    transientDesigner = std::make_unique<TransientDesigner>();
+    // Cache parameter handles for the binary state chunk
+    for (int i = 0; i < numStateParameters; ++i)
+    {
+        stateParameters[(size_t) i] = parameters.getParameter (stateParameterIDs[i]);
+        stateValues[(size_t) i] = parameters.getRawParameterValue (stateParameterIDs[i]);
+        jassert (stateParameters[(size_t) i] != nullptr && stateValues[(size_t) i] != nullptr);
+    }
+
+    // Preset bank (user presets are scanned lazily on first program query)
+    presetBank = std::make_unique<PresetBank> (getDefaultSnapshot(),
+        [this] (const juce::MemoryBlock& block, ParameterSnapshot& snapshot)
+        {
+            return readStateSnapshot (block.getData(), (int) block.getSize(), snapshot);
+        });
+
+    presetBank->onUserPresetsLoaded = [this]
+    {
+        programListChanged = true;
+        triggerAsyncUpdate();
+    };
 }
 
 AtakAtakAudioProcessor::~AtakAtakAudioProcessor()
 {
+    // Stop the preset scan before anything it calls back into goes away
+    presetBank.reset();
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -65,29 +86,80 @@ double AtakAtakAudioProcessor::getTailLengthSeconds() const
 
 int AtakAtakAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return presetBank->getNumPresets(); // Always >= 1: the factory bank starts with "Init"
+}
+
+int AtakAtakAudioProcessor::getNumFactoryPrograms() const
+{
+    return presetBank->getNumFactoryPresets();
 }
 
 int AtakAtakAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram.load();
 }
 
 void AtakAtakAudioProcessor::setCurrentProgram (int index)
 {
-    juce::ignoreUnused (index);
+    auto* preset = presetBank->getPreset (index);
+
+    if (preset == nullptr)
+        return;
+
+    // O(1) for the caller: the audio thread picks the snapshot up at its next block
+    currentProgram = index;
+    pendingProgram.store (&preset->values, std::memory_order_release);
+    programNeedsHostSync = true;
+    triggerAsyncUpdate();
 }
 
 const juce::String AtakAtakAudioProcessor::getProgramName (int index)
 {
-    juce::ignoreUnused (index);
+    if (auto* preset = presetBank->getPreset (index))
+        return preset->name;
+
     return {};
 }
 
 void AtakAtakAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
-    juce::ignoreUnused (index, newName);
+    juce::ignoreUnused (index, newName); // Factory presets are read-only
+}
+
+void AtakAtakAudioProcessor::applyPendingProgram()
+{
+    auto* snapshot = pendingProgram.exchange (nullptr, std::memory_order_acquire);
+
+    if (snapshot == nullptr)
+        return;
+
+    // Whole snapshot lands before updateParameters reads it, so no half-applied presets
+    constexpr int bypassIndex = getStateParameterIndex ("bypass");
+
+    for (int i = 0; i < numStateParameters; ++i)
+        if (i != bypassIndex)
+            stateValues[(size_t) i]->store ((*snapshot)[(size_t) i], std::memory_order_relaxed);
+}
+
+void AtakAtakAudioProcessor::handleAsyncUpdate()
+{
+    if (programNeedsHostSync.exchange (false))
+    {
+        // Bring the parameter objects (and the host) in line with the swapped snapshot
+        if (auto* preset = presetBank->getPreset (currentProgram.load()))
+            applySnapshot (preset->values, false);
+
+        updateHostDisplay (ChangeDetails().withProgramChanged (true));
+    }
+
+    if (programListChanged.exchange (false))
+        updateHostDisplay (ChangeDetails().withProgramChanged (true));
+
+    // Latency changed on the audio thread (detector engine / render profile)
+    const int latency = pendingLatencySamples.exchange (-1);
+
+    if (latency >= 0)
+        setLatencySamples (latency);
 }
 
 //==============================================================================
@@ -99,16 +171,40 @@ void AtakAtakAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     spec.maximumBlockSize = static_cast<juce::uint32> (samplesPerBlock);
     spec.numChannels = static_cast<juce::uint32> (juce::jmax (getTotalNumInputChannels(), getTotalNumOutputChannels()));
     
-    // Prepare gain processors
-    inputGainProcessor->prepare(spec);
-    outputGainProcessor->prepare(spec);
+    // Hosts re-prepare on every transport start; if only the block size moved,
+    // keep the running gain and envelope state instead of rebuilding it
+    const bool layoutChanged = spec.sampleRate != preparedSampleRate || spec.numChannels != preparedNumChannels;
+    preparedSampleRate = spec.sampleRate;
+    preparedNumChannels = spec.numChannels;
     
-    // Reset processors
-    inputGainProcessor->reset();
-    outputGainProcessor->reset();
+    if (layoutChanged)
+    {
+        // Prepare gain processors
+        inputGainProcessor.prepare(spec);
+        outputGainProcessor.prepare(spec);
+        
+        // Reset processors
+        inputGainProcessor.reset();
+        outputGainProcessor.reset();
+    }
     
-    // Initialize transient designer
-    transientDesigner->prepare(spec);
+    // Initialize transient designer (incremental - see TransientDesigner::prepare)
+    transientDesigner.prepare(spec);
+    
+    // Both quality profiles, both detector engines and the true-peak stage are
+    // allocated now; pick the ones in use so the latency is right before playback starts
+    // (the profiles share one latency, the engine and true-peak mode set it)
+    transientDesigner.setRenderQuality(isNonRealtime() ? TransientDesigner::RenderQuality::OFFLINE
+                                                       : TransientDesigner::RenderQuality::REALTIME);
+    transientDesigner.setDetectorEngine(static_cast<DetectorEngine>(static_cast<int>(parameters.getRawParameterValue("detectorEngine")->load())));
+    transientDesigner.setClipperTruePeak(parameters.getRawParameterValue("clipperTruePeak")->load() >= 0.5f);
+    pendingLatencySamples = -1;
+    setLatencySamples(transientDesigner.getLatencySamples());
+    
+    // Dry path for bypass (buffers sized here, never on the audio thread)
+    prepareDryPath(spec);
+    
+    qualityController.prepare(sampleRate);
 }
 
 void AtakAtakAudioProcessor::releaseResources()
@@ -145,7 +241,7 @@ bool AtakAtakAudioProcessor::isBusesLayoutSupported (const BusesLayout& buses) c
 
 void AtakAtakAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    juce::ignoreUnused (midiMessages);
+    const auto blockStartTicks = juce::Time::getHighResolutionTicks();
 
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -157,27 +253,265 @@ void AtakAtakAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // Check if bypassed
-    if (parameters.getRawParameterValue("bypass")->load())
+    // A NaN or inf from the host would otherwise stay in the filter and detector state
+    sanitiseInput (buffer);
+
+    // Swap in a pending program snapshot (lock-free, fixed cost)
+    applyPendingProgram();
+
+    // Follow the host's realtime/offline state, the detector engine choice and the
+    // clipper's true-peak mode (all preallocated; a latency change is reported asynchronously)
+    applyRenderQuality (isNonRealtime());
+    applyDetectorEngine (static_cast<DetectorEngine> (static_cast<int> (parameters.getRawParameterValue ("detectorEngine")->load())));
+    applyTruePeakMode (parameters.getRawParameterValue ("clipperTruePeak")->load() >= 0.5f);
+
+    // Bypass toggles start (or reverse) a short crossfade instead of jumping
+    const bool bypassed = parameters.getRawParameterValue("bypass")->load() >= 0.5f;
+
+    if (bypassed != bypassTarget)
+    {
+        bypassTarget = bypassed;
+        bypassFadeRemaining = bypassFadeLength - bypassFadeRemaining;
+    }
+
+    if (bypassed && bypassFadeRemaining == 0)
     {
-        return; // Pass through unchanged
+        transientDesigner.releaseOnsetNote (midiMessages);
+        renderBypassed (buffer);
+        return;
     }
 
+    // Dry copy for the fade (and to keep the latency delay line running)
+    if (bypassFadeRemaining > 0 || dryDelaySamples > 0)
+        fillDryBuffer (buffer);
+
     // Update parameters
     updateParameters();
     
+    // Realtime only: offline renders have no deadline and always run at full quality
+    const bool adaptiveQuality = ! isNonRealtime() && parameters.getRawParameterValue("adaptiveQuality")->load() >= 0.5f;
+    
+    // Switching it off returns to full quality once, not on every block
+    if (adaptiveQualityActive && ! adaptiveQuality)
+        qualityController.reset();
+    
+    adaptiveQualityActive = adaptiveQuality;
+    
+    transientDesigner.setQualityTier(qualityController.getTier());
+    
     // Process audio
     juce::dsp::AudioBlock<float> block(buffer);
     juce::dsp::ProcessContextReplacing<float> context(block);
     
-    // Apply input gain
-    inputGainProcessor->process(context);
+    // Input gain -> transient designer -> output gain, fused into one pass per channel.
+    // MIDI onset output shares the detector pass and writes into the host's buffer.
+    const bool midiOutput = parameters.getRawParameterValue("midiOutput")->load() >= 0.5f;
+    
+    if (! midiOutput)
+        transientDesigner.releaseOnsetNote(midiMessages);
     
-    // Apply transient designer
-    transientDesigner->process(context);
+    transientDesigner.process(context, inputGainProcessor, outputGainProcessor,
+                              midiOutput ? &midiMessages : nullptr);
     
-    // Apply output gain
-    outputGainProcessor->process(context);
+    if (bypassFadeRemaining > 0)
+        applyBypassCrossfade (buffer);
+
+    if (adaptiveQuality)
+        qualityController.update (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - blockStartTicks),
+                                  buffer.getNumSamples());
+}
+
+void AtakAtakAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ScopedNoDenormals noDenormals;
+    sanitiseInput (buffer);
+    applyRenderQuality (isNonRealtime());
+    applyDetectorEngine (static_cast<DetectorEngine> (static_cast<int> (parameters.getRawParameterValue ("detectorEngine")->load())));
+    applyTruePeakMode (parameters.getRawParameterValue ("clipperTruePeak")->load() >= 0.5f);
+    transientDesigner.releaseOnsetNote (midiMessages);
+    renderBypassed (buffer);
+}
+
+juce::AudioProcessorParameter* AtakAtakAudioProcessor::getBypassParameter() const
+{
+    return parameters.getParameter ("bypass");
+}
+
+//==============================================================================
+const StageProfiler& AtakAtakAudioProcessor::getStageProfiler() const
+{
+    return transientDesigner.getStageProfiler();
+}
+
+size_t AtakAtakAudioProcessor::getMemoryFootprint() const
+{
+    // Dry delay line: maximum delay + 2 samples per channel (juce::dsp::DelayLine layout)
+    const auto dryDelayBytes = (size_t) dryBuffer.getNumChannels() * (size_t) (transientDesigner.getMaxLatencySamples() + 2) * sizeof (float);
+
+    return sizeof (*this) - sizeof (transientDesigner)
+         + transientDesigner.getMemoryFootprint()
+         + (size_t) dryBuffer.getNumChannels() * (size_t) dryBuffer.getNumSamples() * sizeof (float)
+         + dryDelayBytes;
+}
+
+void AtakAtakAudioProcessor::setCachedDetectorEnvelope (const DetectorEnvelopeCache* cache)
+{
+    if (cache != nullptr && cache->isOpen())
+        transientDesigner.setCachedDetectorEnvelope (cache->getChannels(), cache->getNumChannels(), cache->getNumSamples());
+    else
+        transientDesigner.setCachedDetectorEnvelope (nullptr, 0, 0);
+}
+
+void AtakAtakAudioProcessor::applyRenderQuality (bool offline)
+{
+    const auto quality = offline ? TransientDesigner::RenderQuality::OFFLINE
+                                 : TransientDesigner::RenderQuality::REALTIME;
+
+    // Both profiles report the same latency, so the dry path and the host are unaffected
+    transientDesigner.setRenderQuality (quality);
+}
+
+void AtakAtakAudioProcessor::applyDetectorEngine (DetectorEngine engine)
+{
+    if (engine == transientDesigner.getDetectorEngine())
+        return;
+
+    transientDesigner.setDetectorEngine (engine);
+    latencyChangedOnAudioThread();
+
+    // setLatencySamples may not be called from the audio thread
+    pendingLatencySamples = dryDelaySamples;
+    triggerAsyncUpdate();
+}
+
+void AtakAtakAudioProcessor::applyTruePeakMode (bool enabled)
+{
+    if (enabled == transientDesigner.getClipperTruePeak())
+        return;
+
+    transientDesigner.setClipperTruePeak (enabled);
+    latencyChangedOnAudioThread();
+
+    pendingLatencySamples = dryDelaySamples;
+    triggerAsyncUpdate();
+}
+
+void AtakAtakAudioProcessor::latencyChangedOnAudioThread()
+{
+    // The dry path follows the new latency (the delay line is sized for the maximum)
+    dryDelaySamples = transientDesigner.getLatencySamples();
+    dryDelay.reset();
+    dryDelay.setDelay ((float) dryDelaySamples);
+}
+
+void AtakAtakAudioProcessor::prepareDryPath (const juce::dsp::ProcessSpec& spec)
+{
+    dryBuffer.setSize ((int) spec.numChannels, (int) spec.maximumBlockSize, false, false, true);
+
+    // Sized for the longest profile/engine so a switch only moves the read tap
+    const int maxDelaySamples = transientDesigner.getMaxLatencySamples();
+
+    dryDelaySamples = getLatencySamples();
+    dryDelay.setMaximumDelayInSamples (juce::jmax (1, maxDelaySamples));
+    dryDelay.prepare (spec);
+    dryDelay.setDelay ((float) dryDelaySamples);
+
+    bypassFadeLength = juce::jmax (1, juce::roundToInt (spec.sampleRate * 0.01)); // 10ms
+    bypassFadeRemaining = 0;
+    bypassTarget = parameters.getRawParameterValue ("bypass")->load() >= 0.5f;
+}
+
+void AtakAtakAudioProcessor::sanitiseInput (juce::AudioBuffer<float>& buffer)
+{
+    // Non-finite samples become silence; finite input passes through bit-exact
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        auto* samples = buffer.getWritePointer (ch);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            if (! std::isfinite (samples[i]))
+                samples[i] = 0.0f;
+    }
+}
+
+void AtakAtakAudioProcessor::fillDryBuffer (const juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = juce::jmin (buffer.getNumSamples(), dryBuffer.getNumSamples());
+    const int numChannels = juce::jmin (buffer.getNumChannels(), dryBuffer.getNumChannels());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* dry = dryBuffer.getWritePointer (ch);
+        const auto* input = buffer.getReadPointer (ch);
+
+        if (dryDelaySamples == 0)
+        {
+            juce::FloatVectorOperations::copy (dry, input, numSamples);
+            continue;
+        }
+
+        // Align the dry signal with the wet path's reported latency
+        for (int i = 0; i < numSamples; ++i)
+        {
+            dryDelay.pushSample (ch, input[i]);
+            dry[i] = dryDelay.popSample (ch);
+        }
+    }
+}
+
+void AtakAtakAudioProcessor::renderBypassed (juce::AudioBuffer<float>& buffer)
+{
+    // Keep the detectors tracking the input so un-bypassing doesn't start cold
+    const float inputGain = juce::Decibels::decibelsToGain (parameters.getRawParameterValue ("inputGain")->load());
+    transientDesigner.warmDetectors (juce::dsp::AudioBlock<float> (buffer), inputGain);
+
+    if (dryDelaySamples == 0)
+        return; // Dry is the input itself
+
+    fillDryBuffer (buffer);
+
+    const int numSamples = juce::jmin (buffer.getNumSamples(), dryBuffer.getNumSamples());
+    const int numChannels = juce::jmin (buffer.getNumChannels(), dryBuffer.getNumChannels());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        buffer.copyFrom (ch, 0, dryBuffer, ch, 0, numSamples);
+}
+
+void AtakAtakAudioProcessor::applyBypassCrossfade (juce::AudioBuffer<float>& buffer)
+{
+    // Blocks larger than the prepared size can't be faded - finish the fade instead
+    if (buffer.getNumSamples() > dryBuffer.getNumSamples())
+    {
+        bypassFadeRemaining = 0;
+        return;
+    }
+
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin (buffer.getNumChannels(), dryBuffer.getNumChannels());
+    const int fadeSamples = juce::jmin (numSamples, bypassFadeRemaining);
+    const float step = 1.0f / (float) bypassFadeLength;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* wet = buffer.getWritePointer (ch);
+        const auto* dry = dryBuffer.getReadPointer (ch);
+
+        // Fade position runs 0 -> 1 towards the target state
+        float position = (float) (bypassFadeLength - bypassFadeRemaining) * step;
+
+        for (int i = 0; i < fadeSamples; ++i)
+        {
+            position += step;
+            const float wetGain = bypassTarget ? 1.0f - position : position;
+            wet[i] = dry[i] + wetGain * (wet[i] - dry[i]);
+        }
+
+        // Fade finished inside this block and we're heading into bypass: rest is dry
+        if (bypassTarget && fadeSamples < numSamples)
+            juce::FloatVectorOperations::copy (wet + fadeSamples, dry + fadeSamples, numSamples - fadeSamples);
+    }
+
+    bypassFadeRemaining -= fadeSamples;
 }
 
 //==============================================================================
@@ -194,20 +528,101 @@ juce::AudioProcessorEditor* AtakAtakAudioProcessor::createEditor()
 //==============================================================================
 void AtakAtakAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // Save all parameter values to memory block
-    auto state = parameters.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    // Save all parameter values as a fixed-layout binary chunk
+    destData.setSize ((size_t) stateHeaderSize + (size_t) numStateParameters * sizeof (float));
+
+    juce::MemoryOutputStream stream (destData, false);
+    stream.writeInt (stateMagic);
+    stream.writeInt (stateVersion);
+    stream.writeInt (numStateParameters);
+
+    for (auto* value : stateValues)
+        stream.writeFloat (value->load());
 }
 
 void AtakAtakAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // Restore all parameter values from memory block
-    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-    
-    if (xmlState.get() != nullptr)
-        if (xmlState->hasTagName(parameters.state.getType()))
-            parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
+    // Restore all parameter values from memory block (binary or legacy XML)
+    ParameterSnapshot snapshot;
+
+    if (readStateSnapshot (data, sizeInBytes, snapshot))
+        applySnapshot (snapshot);
+}
+
+bool AtakAtakAudioProcessor::readStateSnapshot (const void* data, int sizeInBytes, ParameterSnapshot& snapshot) const
+{
+    // Parameters missing from the chunk (older versions) fall back to their defaults
+    snapshot = getDefaultSnapshot();
+
+    if (data == nullptr || sizeInBytes < stateHeaderSize)
+        return false;
+
+    juce::MemoryInputStream stream (data, (size_t) sizeInBytes, false);
+
+    if (stream.readInt() == stateMagic)
+    {
+        const int version = stream.readInt();
+        const int numValues = stream.readInt();
+
+        if (version < 1 || version > stateVersion || numValues < 0)
+            return false;
+
+        // Entries are append-only, so a shorter chunk maps onto our leading entries
+        const int numToRead = juce::jmin (numValues, numStateParameters);
+
+        if (stream.getNumBytesRemaining() < (juce::int64) numToRead * (juce::int64) sizeof (float))
+            return false;
+
+        for (int i = 0; i < numToRead; ++i)
+            snapshot[(size_t) i] = stream.readFloat();
+
+        return true;
+    }
+
+    // Legacy chunk: APVTS ValueTree serialised through copyXmlToBinary
+    std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
+
+    if (xmlState == nullptr || ! xmlState->hasTagName (parameters.state.getType()))
+        return false;
+
+    auto state = juce::ValueTree::fromXml (*xmlState);
+
+    for (int i = 0; i < numStateParameters; ++i)
+    {
+        auto child = state.getChildWithProperty ("id", juce::String (stateParameterIDs[i]));
+
+        if (child.hasProperty ("value"))
+            snapshot[(size_t) i] = static_cast<float> (child.getProperty ("value"));
+    }
+
+    return true;
+}
+
+void AtakAtakAudioProcessor::applySnapshot (const ParameterSnapshot& snapshot, bool includeBypass)
+{
+    constexpr int bypassIndex = getStateParameterIndex ("bypass");
+
+    for (int i = 0; i < numStateParameters; ++i)
+    {
+        if (i == bypassIndex && ! includeBypass)
+            continue;
+
+        auto* param = stateParameters[(size_t) i];
+        param->setValueNotifyingHost (param->convertTo0to1 (snapshot[(size_t) i]));
+    }
+}
+
+ParameterSnapshot AtakAtakAudioProcessor::getDefaultSnapshot() const
+{
+    ParameterSnapshot snapshot;
+
+    for (int i = 0; i < numStateParameters; ++i)
+    {
+        auto* param = stateParameters[(size_t) i];
+        snapshot[(size_t) i] = param->convertFrom0to1 (param->getDefaultValue());
+    }
+
+    return snapshot;
 }
 
 //==============================================================================
@@ -264,6 +679,8 @@ juce::AudioProcessorValueTreeState::ParameterLayout AtakAtakAudioProcessor::crea
     params.push_back(std::make_unique<juce::AudioParameterFloat>("clipperDrive", "Clipper Drive", 1.0f, 10.0f, 2.0f)); // Drive intensity
     params.push_back(std::make_unique<juce::AudioParameterChoice>("clipperType", "Clipper Type", 
         juce::StringArray{"Hard", "Quintic", "Cubic", "Tangent", "Algebraic", "Arctangent"}, 1)); // Default: Quintic
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("clipperAntialiasing", "Clipper Anti-aliasing",
+        juce::StringArray{"Off", "ADAA 1st Order", "ADAA 2nd Order"}, 0)); // Antiderivative anti-aliasing
     
     // Sensitivity removed - STA/LTA is automatic!
     // Mix parameter
@@ -272,6 +689,27 @@ juce::AudioProcessorValueTreeState::ParameterLayout AtakAtakAudioProcessor::crea
     params.push_back(std::make_unique<juce::AudioParameterBool>("bypass", "Bypass", false));
     params.push_back(std::make_unique<juce::AudioParameterBool>("resetToDefaults", "Reset to Defaults", false));
     
+    // MIDI onset output (drum trigger from the transient detector)
+    params.push_back(std::make_unique<juce::AudioParameterBool>("midiOutput", "MIDI Output", false));
+    params.push_back(std::make_unique<juce::AudioParameterInt>("midiNote", "MIDI Note", 0, 127, 36));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("midiThreshold", "MIDI Threshold", -60.0f, -1.0f, -30.0f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("midiHoldMs", "MIDI Retrigger Hold", 5.0f, 500.0f, 50.0f));
+    
+    // Step quality down under CPU pressure instead of dropping out
+    params.push_back(std::make_unique<juce::AudioParameterBool>("adaptiveQuality", "Adaptive Quality", false));
+    
+    // Transient detection engine (Spectral Flux adds lookahead latency). Not automatable:
+    // every change of it changes the reported latency
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("detectorEngine", "Detector Engine",
+        juce::StringArray{"Envelope", "Spectral Flux"}, 0, juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+    
+    // Clipper limits intersample (true) peaks too (adds a short fixed latency, so not automatable either)
+    params.push_back(std::make_unique<juce::AudioParameterBool>("clipperTruePeak", "Clipper True Peak", false,
+        juce::AudioParameterBoolAttributes().withAutomatable(false)));
+    
+    // Slow detector envelopes at a decimated control rate (cheaper, bounded error)
+    params.push_back(std::make_unique<juce::AudioParameterBool>("ecoDetection", "Eco Detection", false));
+    
     return { params.begin(), params.end() };
 }
 
@@ -281,30 +719,26 @@ void AtakAtakAudioProcessor::updateParameters()
     float inputGainLinear = juce::Decibels::decibelsToGain(parameters.getRawParameterValue("inputGain")->load());
     float outputGainLinear = juce::Decibels::decibelsToGain(parameters.getRawParameterValue("outputGain")->load());
     
-    inputGainProcessor->setGainLinear(inputGainLinear);
-    outputGainProcessor->setGainLinear(outputGainLinear);
+    inputGainProcessor.setGainLinear(inputGainLinear);
+    outputGainProcessor.setGainLinear(outputGainLinear);
     
     // Update transient designer parameters
-    transientDesigner->setAttackAmount(parameters.getRawParameterValue("attackAmount")->load());
-    transientDesigner->setSustainAmount(parameters.getRawParameterValue("sustainAmount")->load());
-    transientDesigner->setAttackTime(parameters.getRawParameterValue("attackTime")->load());
-    transientDesigner->setReleaseTime(parameters.getRawParameterValue("releaseTime")->load());
-    transientDesigner->setAttackThreshold(juce::Decibels::decibelsToGain(parameters.getRawParameterValue("attackThreshold")->load()));
-    transientDesigner->setSustainThreshold(juce::Decibels::decibelsToGain(parameters.getRawParameterValue("sustainThreshold")->load()));
+    transientDesigner.setAttackAmount(parameters.getRawParameterValue("attackAmount")->load());
+    transientDesigner.setSustainAmount(parameters.getRawParameterValue("sustainAmount")->load());
+    transientDesigner.setAttackTime(parameters.getRawParameterValue("attackTime")->load());
+    transientDesigner.setReleaseTime(parameters.getRawParameterValue("releaseTime")->load());
+    transientDesigner.setAttackThreshold(juce::Decibels::decibelsToGain(parameters.getRawParameterValue("attackThreshold")->load()));
+    transientDesigner.setSustainThreshold(juce::Decibels::decibelsToGain(parameters.getRawParameterValue("sustainThreshold")->load()));
     // Sensitivity removed - STA/LTA is automatic!
-    transientDesigner->setMix(parameters.getRawParameterValue("mix")->load() / 100.0f);
+    transientDesigner.setMix(parameters.getRawParameterValue("mix")->load() / 100.0f);
     
     // Update psychoacoustic parameters
-    transientDesigner->setMaskingThreshold(parameters.getRawParameterValue("maskingThreshold")->load());
-    transientDesigner->setCriticalBandWeight(parameters.getRawParameterValue("criticalBandWeight")->load());
-    transientDesigner->setTemporalWeight(parameters.getRawParameterValue("temporalWeight")->load());
-    
-    // Update SPL Differential Envelope parameters
-    float fastAttackMs = parameters.getRawParameterValue("fastAttackMs")->load();
-    float slowAttackMs = parameters.getRawParameterValue("slowAttackMs")->load();
-    float releaseMs = parameters.getRawParameterValue("releaseMs")->load();
-    float powerMemoryMs = parameters.getRawParameterValue("powerMemoryMs")->load();
-    // SPL Mode removed - STA/LTA is automatic!
+    transientDesigner.setMaskingThreshold(parameters.getRawParameterValue("maskingThreshold")->load());
+    transientDesigner.setCriticalBandWeight(parameters.getRawParameterValue("criticalBandWeight")->load());
+    transientDesigner.setTemporalWeight(parameters.getRawParameterValue("temporalWeight")->load());
+    
+    // SPL Differential Envelope parameters (fastAttackMs, slowAttackMs, releaseMs,
+    // powerMemoryMs) stay in the layout for saved sessions; SPL Mode removed - STA/LTA is automatic!
     // STA/LTA parameters are built-in - no setup needed!
     
     // Update SNAP enhancement parameters
@@ -312,9 +746,9 @@ void AtakAtakAudioProcessor::updateParameters()
     float snapHardness = parameters.getRawParameterValue("snapHardness")->load();
     float harmonicEnhancement = parameters.getRawParameterValue("harmonicEnhancement")->load();
     
-    transientDesigner->setSnapAmount(snapAmount);
-    transientDesigner->setSnapHardness(snapHardness);
-    transientDesigner->setHarmonicEnhancement(harmonicEnhancement);
+    transientDesigner.setSnapAmount(snapAmount);
+    transientDesigner.setSnapHardness(snapHardness);
+    transientDesigner.setHarmonicEnhancement(harmonicEnhancement);
     
     // Update DrumSnapper-inspired parameters
     float focus = parameters.getRawParameterValue("focus")->load();
@@ -322,25 +756,34 @@ void AtakAtakAudioProcessor::updateParameters()
     float hfSaturation = parameters.getRawParameterValue("hfSaturation")->load();
     bool tapeClip = parameters.getRawParameterValue("tapeClip")->load();
     
-    transientDesigner->setFocus(focus);
-    transientDesigner->setHFGain(hfGain);
-    transientDesigner->setHFSaturation(hfSaturation);
-    transientDesigner->setTapeClip(tapeClip);
+    transientDesigner.setFocus(focus);
+    transientDesigner.setHFGain(hfGain);
+    transientDesigner.setHFSaturation(hfSaturation);
+    transientDesigner.setTapeClip(tapeClip);
     
     // Update PeakEater-style Clipper parameters
     bool clipperEnabled = parameters.getRawParameterValue("clipperEnabled")->load();
     float clipperCeiling = parameters.getRawParameterValue("clipperCeiling")->load();
     float clipperDrive = parameters.getRawParameterValue("clipperDrive")->load();
     int clipperTypeIndex = static_cast<int>(parameters.getRawParameterValue("clipperType")->load());
+    int clipperAntialiasingIndex = static_cast<int>(parameters.getRawParameterValue("clipperAntialiasing")->load());
     
-    transientDesigner->setClipperEnabled(clipperEnabled);
-    transientDesigner->setClipperCeiling(clipperCeiling);
-    transientDesigner->setClipperDrive(clipperDrive);
-    transientDesigner->setClipperType(static_cast<ClipperType>(clipperTypeIndex));
+    transientDesigner.setClipperEnabled(clipperEnabled);
+    transientDesigner.setClipperCeiling(clipperCeiling);
+    transientDesigner.setClipperDrive(clipperDrive);
+    transientDesigner.setClipperType(static_cast<ClipperType>(clipperTypeIndex));
+    transientDesigner.setClipperAntialiasing(static_cast<ClipperAntialiasing>(clipperAntialiasingIndex));
     
     // Update Auto Gain Compensation
     bool autoGainComp = parameters.getRawParameterValue("autoGainComp")->load();
-    transientDesigner->setAutoGainComp(autoGainComp);
+    transientDesigner.setAutoGainComp(autoGainComp);
+    
+    // Update MIDI onset output
+    transientDesigner.setOnsetNote(static_cast<int>(parameters.getRawParameterValue("midiNote")->load()));
+    transientDesigner.setOnsetThreshold(parameters.getRawParameterValue("midiThreshold")->load());
+    transientDesigner.setOnsetHoldTime(parameters.getRawParameterValue("midiHoldMs")->load());
+    
+    transientDesigner.setEcoDetection(parameters.getRawParameterValue("ecoDetection")->load() >= 0.5f);
     
     // Handle reset to defaults
     bool resetToDefaults = parameters.getRawParameterValue("resetToDefaults")->load();
@@ -349,16 +792,6 @@ void AtakAtakAudioProcessor::updateParameters()
         // Reset the button back to false
         parameters.getRawParameterValue("resetToDefaults")->store(0.0f);
     }
-    
-    // Debug output (remove in production)
-    static int debugCounter = 0;
-    if (++debugCounter % 44100 == 0) { // Once per second at 44.1kHz
-        std::cout << "STA/LTA Mode: AUTOMATIC"
-                  << ", Fast Attack: " << fastAttackMs 
-                  << ", Slow Attack: " << slowAttackMs
-                  << ", Release: " << releaseMs
-                  << ", Power Memory: " << powerMemoryMs << std::endl;
-    }
 }
 
 void AtakAtakAudioProcessor::resetAllParametersToDefaults()
@@ -399,9 +832,20 @@ void AtakAtakAudioProcessor::resetAllParametersToDefaults()
     parameters.getRawParameterValue("clipperCeiling")->store(0.8f);
     parameters.getRawParameterValue("clipperDrive")->store(2.0f);
     parameters.getRawParameterValue("clipperType")->store(1.0f); // Quintic
+    parameters.getRawParameterValue("clipperAntialiasing")->store(0.0f); // Off
     
     // Sensitivity removed - STA/LTA is automatic!
     parameters.getRawParameterValue("mix")->store(100.0f);
     parameters.getRawParameterValue("autoGainComp")->store(1.0f);
     parameters.getRawParameterValue("bypass")->store(0.0f);
+    
+    parameters.getRawParameterValue("midiOutput")->store(0.0f);
+    parameters.getRawParameterValue("midiNote")->store(36.0f);
+    parameters.getRawParameterValue("midiThreshold")->store(-30.0f);
+    parameters.getRawParameterValue("midiHoldMs")->store(50.0f);
+    
+    parameters.getRawParameterValue("adaptiveQuality")->store(0.0f);
+    parameters.getRawParameterValue("detectorEngine")->store(0.0f); // Envelope
+    parameters.getRawParameterValue("clipperTruePeak")->store(0.0f);
+    parameters.getRawParameterValue("ecoDetection")->store(0.0f);
 } 
\ No newline at end of file
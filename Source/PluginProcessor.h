@@ -3,169 +3,483 @@
 #include "../JUCE/modules/juce_audio_processors/juce_audio_processors.h"
 #include "../JUCE/modules/juce_dsp/juce_dsp.h"
 #include "../JUCE/modules/juce_audio_basics/juce_audio_basics.h"
+#include "Clipper.h"
+#include "StageProfiler.h"
+#include "QualityController.h"
+#include "SpectralFluxDetector.h"
+#include "StateArena.h"
+#include "TruePeak.h"
+#include <array>
 #include <cmath>
+#include <iterator>
+#include <string_view>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
 // Forward declarations
-class TransientDesigner;
-class GainProcessor;
-
-// PeakEater-inspired Clipper Types (optimized for drums)
-enum class ClipperType {
-    HARD = 0,
-    QUINTIC,
-    CUBIC, 
-    TANGENT,
-    ALGEBRAIC,
-    ARCTANGENT
-};
+class PresetBank;
+class DetectorEnvelopeCache;
 
 //==============================================================================
-/**
-*/
-class AtakAtakAudioProcessor  : public juce::AudioProcessor
-{
-public:
-    //==============================================================================
-    AtakAtakAudioProcessor();
-    ~AtakAtakAudioProcessor() override;
-
-    //==============================================================================
-    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override;
-
-   #ifndef JucePlugin_PreferredChannelConfigurations
-    bool isBusesLayoutSupported (const BusesLayout& buses) const override;
-   #endif
-
-    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-
-    //==============================================================================
-    juce::AudioProcessorEditor* createEditor() override;
-    bool hasEditor() const override;
-
-    //==============================================================================
-    const juce::String getName() const override;
-
-    bool acceptsMidi() const override;
-    bool producesMidi() const override;
-    bool isMidiEffect() const override;
-    double getTailLengthSeconds() const override;
-
-    //==============================================================================
-    int getNumPrograms() override;
-    int getCurrentProgram() override;
-    void setCurrentProgram (int index) override;
-    const juce::String getProgramName (int index) override;
-    void changeProgramName (int index, const juce::String& newName) override;
+// Parameter IDs in binary state order. The compact state chunk stores plain
+// values positionally, so this list is append-only: new parameters go at the
+// end and existing entries never move. resetToDefaults is a momentary button
+// and is deliberately not persisted.
+inline constexpr const char* stateParameterIDs[] = {
+    "inputGain", "outputGain",
+    "attackAmount", "attackTime", "attackThreshold",
+    "sustainAmount", "releaseTime", "sustainThreshold",
+    "maskingThreshold", "criticalBandWeight", "temporalWeight",
+    "fastAttackMs", "slowAttackMs", "releaseMs", "powerMemoryMs",
+    "snapAmount", "snapHardness", "harmonicEnhancement",
+    "focus", "hfGain", "hfSaturation", "tapeClip",
+    "clipperEnabled", "clipperCeiling", "clipperDrive", "clipperType",
+    "mix", "autoGainComp", "bypass",
+    "clipperAntialiasing",
+    "midiOutput", "midiNote", "midiThreshold", "midiHoldMs",
+    "adaptiveQuality",
+    "detectorEngine",
+    "clipperTruePeak",
+    "ecoDetection"
+};
 
-    //==============================================================================
-    void getStateInformation (juce::MemoryBlock& destData) override;
-    void setStateInformation (const void* data, int sizeInBytes) override;
+inline constexpr int numStateParameters = static_cast<int> (std::size (stateParameterIDs));
 
-    //==============================================================================
-    // Parameter access
-    juce::AudioProcessorValueTreeState& getAPVTS() { return parameters; }
-    
-    //==============================================================================
-    // Parameter layout
-    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-
-private:
-    //==============================================================================
-    void updateParameters();
-    void resetAllParametersToDefaults();
+// Plain (denormalised) parameter values in stateParameterIDs order
+using ParameterSnapshot = std::array<float, numStateParameters>;
 
+constexpr int getStateParameterIndex (std::string_view id)
+{
+    for (int i = 0; i < numStateParameters; ++i)
+        if (id == stateParameterIDs[i])
+            return i;
 
+    return -1;
+}
 
-    // DSP processors
-    std::unique_ptr<GainProcessor> inputGainProcessor;
-    std::unique_ptr<GainProcessor> outputGainProcessor;
-    std::unique_ptr<TransientDesigner> transientDesigner;
-    
-    // Parameter tree
-    juce::AudioProcessorValueTreeState parameters;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AtakAtakAudioProcessor)
-};
+//==============================================================================
+// Eco detection: the slow envelopes update once per control interval instead of
+// every sample (see DualEnvelopeDetector::processControlRate)
+namespace ControlRate
+{
+    // About 6 kHz at any rate: 8 samples at 44.1/48 kHz, 16 at 96 kHz, 32 at 192 kHz
+    inline int getInterval(double sampleRate)
+    {
+        return juce::jlimit(8, 32, juce::nextPowerOfTwo(juce::roundToInt(sampleRate / 6000.0)));
+    }
+}
 
 //==============================================================================
 // Dual Envelope Transient Detector (based on Envolvigo approach)
 // Fast envelope vs Slow envelope - continuous control, no gating!
 class DualEnvelopeDetector {
+public:
+    // Shared by every channel of an instance; only recomputed when the sample rate changes
+    struct Coefficients {
+        float fastReleaseCoeff = 0.0f;
+        float slowAttackCoeff = 0.0f, slowReleaseCoeff = 0.0f;
+        double sampleRate = 0.0;
+        
+        // Eco detection: per-sample slow rates (1 - coeff) and the control interval
+        float slowAttackRate = 0.0f, slowRateDifference = 0.0f;
+        int controlInterval = 8;
+        float invControlInterval = 0.125f;
+        
+        void prepare(double newSampleRate) {
+            if (newSampleRate == sampleRate)
+                return;
+            
+            sampleRate = newSampleRate;
+            const float sr = static_cast<float>(newSampleRate);
+            
+            // Fast envelope: instant attack, 10ms release
+            fastReleaseCoeff = std::exp(-1.0f / (sr * 0.01f));  // 10ms release
+            
+            // Slow envelope: 50ms attack, 100ms release  
+            slowAttackCoeff = std::exp(-1.0f / (sr * 0.05f));   // 50ms attack
+            slowReleaseCoeff = std::exp(-1.0f / (sr * 0.1f));   // 100ms release
+            
+            slowAttackRate = 1.0f - slowAttackCoeff;
+            slowRateDifference = slowAttackRate - (1.0f - slowReleaseCoeff);
+            controlInterval = ControlRate::getInterval(newSampleRate);
+            invControlInterval = 1.0f / static_cast<float>(controlInterval);
+        }
+        
+        // Largest |processControlRate - process| as a fraction of the input peak.
+        // One interval moves the slow envelope by at most controlInterval * slowAttackRate
+        // of the peak; the interpolation trails it by up to two intervals and holding
+        // it within an interval costs less than one more. 0.011 at 44.1 kHz and its
+        // multiples, 0.010 at 48 kHz and its multiples.
+        float getControlRateErrorBound() const {
+            return 3.0f * static_cast<float>(controlInterval) * slowAttackRate;
+        }
+    };
+    
 private:
-    float fastAttackCoeff, fastReleaseCoeff;
-    float slowAttackCoeff, slowReleaseCoeff;
     float fastEnvelope, slowEnvelope;
     
+    // Eco detection: the interpolated slow envelope, the current interval's sums of
+    // the levels and of their distances from the slow envelope, and the last
+    // interval's mean level
+    float interpolatedSlow = 0.0f, slowStep = 0.0f;
+    float levelSum = 0.0f, distanceSum = 0.0f, intervalLevel = 0.0f;
+    int controlPhase = 0;
+    
 public:
     DualEnvelopeDetector() : fastEnvelope(0.0f), slowEnvelope(0.0f) {}
     
-    void prepare(float sampleRate) {
-        // Fast envelope: instant attack, 10ms release
-        fastAttackCoeff = 0.0f;  // Instant attack
-        fastReleaseCoeff = std::exp(-1.0f / (sampleRate * 0.01f));  // 10ms release
-        
-        // Slow envelope: 50ms attack, 100ms release  
-        slowAttackCoeff = std::exp(-1.0f / (sampleRate * 0.05f));   // 50ms attack
-        slowReleaseCoeff = std::exp(-1.0f / (sampleRate * 0.1f));   // 100ms release
-    }
-    
-    float process(float input) {
+    float process(float input, const Coefficients& c) {
         float absInput = std::abs(input);
         
         // Fast envelope: instant up, slow down
         if (absInput > fastEnvelope) {
             fastEnvelope = absInput;  // Instant attack
         } else {
-            fastEnvelope = fastEnvelope * fastReleaseCoeff + absInput * (1.0f - fastReleaseCoeff);
+            fastEnvelope = fastEnvelope * c.fastReleaseCoeff + absInput * (1.0f - c.fastReleaseCoeff);
         }
         
         // Slow envelope: slow up, slow down
         if (absInput > slowEnvelope) {
-            slowEnvelope = slowEnvelope * slowAttackCoeff + absInput * (1.0f - slowAttackCoeff);
+            slowEnvelope = slowEnvelope * c.slowAttackCoeff + absInput * (1.0f - c.slowAttackCoeff);
         } else {
-            slowEnvelope = slowEnvelope * slowReleaseCoeff + absInput * (1.0f - slowReleaseCoeff);
+            slowEnvelope = slowEnvelope * c.slowReleaseCoeff + absInput * (1.0f - c.slowReleaseCoeff);
         }
         
         // Return difference (transient strength) - always >= 0
         return std::max(0.0f, fastEnvelope - slowEnvelope);
     }
     
+    // Eco detection over a run of samples, stopping early at the end of the current
+    // control interval; returns the samples consumed (isControlStep() is then true
+    // if the interval completed). Only the fast envelope runs at audio rate (same
+    // values as process). Each sample just adds to the interval's sums; the slow
+    // envelope updates once per interval from them (updateSlowEnvelope) and is
+    // linearly interpolated across the next interval. The run keeps the state in
+    // locals, so nothing goes through memory per sample. Error bound:
+    // Coefficients::getControlRateErrorBound().
+    int processControlRate(const float* input, float* strength, int numSamples, const Coefficients& c) {
+        const int count = std::min(numSamples, c.controlInterval - controlPhase);
+        const float releaseRate = 1.0f - c.fastReleaseCoeff;
+        const float slow = slowEnvelope, step = slowStep;
+        float fast = fastEnvelope, interpolated = interpolatedSlow;
+        float levels = levelSum, distances = distanceSum;
+        
+        for (int i = 0; i < count; ++i) {
+            const float absInput = std::abs(input[i]);
+            
+            if (absInput > fast) {
+                fast = absInput;
+            } else {
+                fast = fast * c.fastReleaseCoeff + absInput * releaseRate;
+            }
+            
+            levels += absInput;
+            distances += std::abs(absInput - slow);
+            
+            interpolated += step;
+            strength[i] = std::max(0.0f, fast - interpolated);
+        }
+        
+        fastEnvelope = fast;
+        interpolatedSlow = interpolated;
+        levelSum = levels;
+        distanceSum = distances;
+        
+        if ((controlPhase += count) == c.controlInterval) {
+            controlPhase = 0;
+            updateSlowEnvelope(c);
+        }
+        
+        return count;
+    }
+    
+    // One sample of eco detection
+    float processControlRate(float input, const Coefficients& c) {
+        float strength;
+        processControlRate(&input, &strength, 1, c);
+        return strength;
+    }
+    
+    // True right after the sample that completed a control interval
+    bool isControlStep() const { return controlPhase == 0; }
+    
+    // Mean input level of the last completed control interval
+    float getIntervalLevel() const { return intervalLevel; }
+    
+    // Switching to eco detection: continue from the current slow envelope
+    void enterControlRate() {
+        interpolatedSlow = slowEnvelope;
+        slowStep = levelSum = distanceSum = 0.0f;
+        controlPhase = 0;
+    }
+    
     void reset() {
         fastEnvelope = slowEnvelope = 0.0f;
+        enterControlRate();
     }
     
     // Get individual envelopes for debugging
     float getFastEnvelope() const { return fastEnvelope; }
     float getSlowEnvelope() const { return slowEnvelope; }
+    
+private:
+    // One control step: the sum of the attack/release steps the audio-rate envelope
+    // would take from its held value over the interval. With d = level - slow, each
+    // step is attackRate * d above the envelope and releaseRate * d below it, i.e.
+    // attackRate * d - rateDifference * min(d, 0), and min(d, 0) = (d - |d|) / 2, so
+    // only the sums of the levels and of |d| are needed.
+    void updateSlowEnvelope(const Coefficients& c) {
+        const float difference = levelSum - static_cast<float>(c.controlInterval) * slowEnvelope;
+        
+        slowEnvelope += c.slowAttackRate * difference - c.slowRateDifference * 0.5f * (difference - distanceSum);
+        slowStep = (slowEnvelope - interpolatedSlow) * c.invControlInterval;
+        intervalLevel = levelSum * c.invControlInterval;
+        levelSum = distanceSum = 0.0f;
+    }
+};
+
+//==============================================================================
+// Drum trigger from the detector output: peak picking on the (channel-linked)
+// transient strength, one note-on per peak with velocity from its level, and a
+// retrigger hold after which the note is released. Events are delayed by the
+// latency the audio gets after detection (setOutputDelay), so they stay on the
+// transient once the host compensates it. Events due in the current block go
+// straight into the host's MidiBuffer, later ones wait in a fixed queue; at most
+// one on/off pair per hold period, no state allocation.
+class OnsetTrigger {
+public:
+    void prepare(double newSampleRate) {
+        sampleRate = newSampleRate;
+        setHoldTime(holdMs);
+        reset();
+    }
+    
+    void reset() {
+        state = State::IDLE;
+        peak = 0.0f;
+        peakAge = 0;
+        holdRemaining = 0;
+        numPending = 0;
+        blockStart = lastDue = 0;
+        blockLength = 0;
+    }
+    
+    void setNote(int note) { noteNumber = juce::jlimit(0, 127, note); }
+    void setThreshold(float thresholdDb) {
+        thresholdDecibels = std::min(-1.0f, thresholdDb);
+        threshold = juce::Decibels::decibelsToGain(thresholdDecibels);
+    }
+    void setHoldTime(float ms) {
+        holdMs = ms;
+        holdSamples = std::max(1, static_cast<int>(sampleRate * ms * 0.001));
+    }
+    
+    // Samples between the detector and the output (oversampler, true-peak lookahead)
+    void setOutputDelay(int samples) { outputDelay = std::max(0, samples); }
+    
+    // Starts a block of numSamples: writes the queued events that fall inside it
+    void beginBlock(juce::MidiBuffer& midi, int numSamples) {
+        blockStart += blockLength;
+        blockLength = numSamples;
+        
+        while (numPending > 0 && pending[pendingHead].due < blockStart + blockLength)
+            writePending(midi);
+    }
+    
+    // strength[i] belongs to block sample (blockOffset + i)
+    void process(const float* strength, int numSamples, int blockOffset, juce::MidiBuffer& midi) {
+        for (int i = 0; i < numSamples; ++i) {
+            const float s = strength[i];
+            
+            switch (state) {
+                case State::IDLE:
+                    if (s >= threshold) {
+                        state = State::PEAK;
+                        peak = s;
+                        peakAge = 0;
+                    }
+                    break;
+                
+                case State::PEAK:
+                    if (s > peak) {
+                        peak = s;
+                        peakAge = 0;
+                        break;
+                    }
+                    
+                    // First falling sample: the previous maximum is the onset peak
+                    ++peakAge;
+                    if (s < peak) {
+                        // A peak in the previous block is moved up to the current one
+                        activeNote = noteNumber;
+                        addEvent(midi, activeNote, velocityFor(peak), blockOffset + i - peakAge);
+                        holdRemaining = std::max(1, holdSamples - peakAge);
+                        state = State::HOLD;
+                    }
+                    break;
+                
+                case State::HOLD:
+                    if (--holdRemaining <= 0) {
+                        addEvent(midi, activeNote, 0, blockOffset + i);
+                        activeNote = -1;
+                        state = State::REARM;
+                    }
+                    break;
+                
+                case State::REARM:
+                    // Wait for the strength to drop so a plateau can't retrigger
+                    if (s < threshold)
+                        state = State::IDLE;
+                    break;
+            }
+        }
+    }
+    
+    // Ends a sounding note now (output disabled, bypass): queued events are written
+    // at position first. Stops tracking the current peak.
+    void releaseNote(juce::MidiBuffer& midi, int position) {
+        while (numPending > 0)
+            writePending(midi, position);
+        
+        lastDue = 0;
+        
+        if (activeNote >= 0) {
+            midi.addEvent(juce::MidiMessage::noteOff(midiChannel, activeNote), position);
+            activeNote = -1;
+        }
+        
+        if (state == State::PEAK || state == State::HOLD)
+            state = State::REARM;
+    }
+    
+private:
+    enum class State { IDLE, PEAK, HOLD, REARM };
+    
+    // Queued event: velocity 0 is the note-off
+    struct Event {
+        juce::int64 due;
+        int note;
+        juce::uint8 velocity;
+    };
+    
+    static constexpr int maxPending = 32;
+    
+    // Delayed by outputDelay, in order (a shorter delay never overtakes queued events)
+    void addEvent(juce::MidiBuffer& midi, int note, juce::uint8 velocity, int position) {
+        const juce::int64 due = std::max({ blockStart + position + outputDelay, blockStart, lastDue });
+        lastDue = due;
+        
+        if (numPending == 0 && due < blockStart + blockLength) {
+            midi.addEvent(makeMessage(note, velocity), static_cast<int>(due - blockStart));
+            return;
+        }
+        
+        // Full queue (hold times far below the delay): the oldest event goes out now
+        if (numPending == maxPending)
+            writePending(midi, 0);
+        
+        pending[(pendingHead + numPending++) % maxPending] = { due, note, velocity };
+    }
+    
+    // Writes the oldest queued event at its due position, or at position if given
+    void writePending(juce::MidiBuffer& midi, int position = -1) {
+        const auto& event = pending[pendingHead];
+        const int offset = position >= 0 ? position : static_cast<int>(std::max(juce::int64(0), event.due - blockStart));
+        midi.addEvent(makeMessage(event.note, event.velocity), offset);
+        pendingHead = (pendingHead + 1) % maxPending;
+        --numPending;
+    }
+    
+    static juce::MidiMessage makeMessage(int note, juce::uint8 velocity) {
+        return velocity > 0 ? juce::MidiMessage::noteOn(midiChannel, note, velocity)
+                            : juce::MidiMessage::noteOff(midiChannel, note);
+    }
+    
+    // Linear in dB from the threshold (velocity 1) to 0 dBFS strength (127)
+    juce::uint8 velocityFor(float strength) const {
+        const float db = juce::Decibels::gainToDecibels(strength, thresholdDecibels);
+        const float position = juce::jlimit(0.0f, 1.0f, (db - thresholdDecibels) / -thresholdDecibels);
+        return static_cast<juce::uint8>(1 + juce::roundToInt(position * 126.0f));
+    }
+    
+    static constexpr int midiChannel = 1;
+    
+    double sampleRate = 44100.0;
+    State state = State::IDLE;
+    float peak = 0.0f;
+    int peakAge = 0;
+    int holdRemaining = 0;
+    int activeNote = -1;
+    
+    // Output delay queue; times in samples since prepare
+    std::array<Event, maxPending> pending {};
+    int pendingHead = 0, numPending = 0;
+    int outputDelay = 0, blockLength = 0;
+    juce::int64 blockStart = 0, lastDue = 0;
+    
+    int noteNumber = 36;
+    float thresholdDecibels = -30.0f;
+    float threshold = 0.0316f;
+    float holdMs = 50.0f;
+    int holdSamples = 2205;
 };
 
 //==============================================================================
 // EnvelopeFollower from compendium
 class EnvelopeFollower {
+public:
+    // Shared by every channel, keyed by (attack, release, sample rate)
+    struct Coefficients {
+        float attack_coeff = 0.0f, release_coeff = 0.0f;
+        float attack_ms = -1.0f, release_ms = -1.0f, sample_rate = 0.0f;
+        
+        // Eco detection: one step per control interval
+        int control_interval = 8;
+        float attack_coeff_control = 0.0f, release_coeff_control = 0.0f;
+        
+        void set_times(float new_attack_ms, float new_release_ms, float new_sample_rate) {
+            if (new_attack_ms == attack_ms && new_release_ms == release_ms && new_sample_rate == sample_rate)
+                return; // Called every block - only pay for exp() when something changed
+            
+            attack_ms = new_attack_ms;
+            release_ms = new_release_ms;
+            sample_rate = new_sample_rate;
+            attack_coeff = std::exp(-1.0f / (attack_ms * sample_rate * 0.001f));
+            release_coeff = std::exp(-1.0f / (release_ms * sample_rate * 0.001f));
+            
+            control_interval = ControlRate::getInterval(sample_rate);
+            attack_coeff_control = std::pow(attack_coeff, static_cast<float>(control_interval));
+            release_coeff_control = std::pow(release_coeff, static_cast<float>(control_interval));
+        }
+    };
+    
 private:
-    float attack_coeff, release_coeff;
     float envelope;
     
 public:
     EnvelopeFollower() : envelope(0.0f) {}
     
-    void set_times(float attack_ms, float release_ms, float sample_rate) {
-        attack_coeff = exp(-1.0f / (attack_ms * sample_rate * 0.001f));
-        release_coeff = exp(-1.0f / (release_ms * sample_rate * 0.001f));
-    }
-    
-    float process(float input) {
+    float process(float input, const Coefficients& c) {
         float input_level = fabs(input);
         
         if (input_level > envelope) {
-            envelope = attack_coeff * envelope + (1.0f - attack_coeff) * input_level;
+            envelope = c.attack_coeff * envelope + (1.0f - c.attack_coeff) * input_level;
         } else {
-            envelope = release_coeff * envelope + (1.0f - release_coeff) * input_level;
+            envelope = c.release_coeff * envelope + (1.0f - c.release_coeff) * input_level;
+        }
+        
+        return envelope;
+    }
+    
+    // Eco detection: one step per control interval on the interval's mean level
+    // (DualEnvelopeDetector::getIntervalLevel)
+    float processControlStep(float interval_level, const Coefficients& c) {
+        if (interval_level > envelope) {
+            envelope = c.attack_coeff_control * envelope + (1.0f - c.attack_coeff_control) * interval_level;
+        } else {
+            envelope = c.release_coeff_control * envelope + (1.0f - c.release_coeff_control) * interval_level;
         }
         
         return envelope;
@@ -176,6 +490,136 @@ public:
     }
 };
 
+//==============================================================================
+// HF band for the HF Saturation stage: 4th-order Linkwitz-Riley high-pass (two
+// identical Butterworth biquads) in transposed direct form II. Coefficients are
+// shared by every channel and only recomputed when the sample rate changes.
+//
+// processBlock runs the same filter blockLength samples at a time. A block's
+// outputs and end state are linear in its start state (the four TDF-II registers)
+// and its inputs, so they are SIMD multiply-adds over precomputed response
+// columns instead of a per-sample recursion (about 3x faster than process()).
+class HFBandFilter {
+public:
+    using Vec = juce::dsp::SIMDRegister<float>;
+    static constexpr int blockLength = 8;
+    static constexpr int numStates = 4;
+    static_assert(blockLength % static_cast<int>(Vec::size()) == 0 && numStates <= static_cast<int>(Vec::size()),
+                  "a block is whole registers and the state fits one");
+    
+    struct Coefficients {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+        double sampleRate = 0.0;
+        
+        // Block form: the block's outputs (and end state, zero padded to a register)
+        // for a unit start state per register and a unit input per block position
+        alignas(Vec) float stateToOutput[numStates][blockLength] {};
+        alignas(Vec) float inputToOutput[blockLength][blockLength] {};
+        alignas(Vec) float stateToState[numStates][blockLength] {};
+        alignas(Vec) float inputToState[blockLength][blockLength] {};
+        
+        void prepare(double newSampleRate, double cutoffHz) {
+            if (newSampleRate == sampleRate)
+                return;
+            
+            sampleRate = newSampleRate;
+            
+            // RBJ high-pass, Q = 1/sqrt(2); cutoff kept clear of Nyquist
+            const double w0 = 2.0 * M_PI * std::min(cutoffHz, 0.45 * newSampleRate) / newSampleRate;
+            const double cosW0 = std::cos(w0);
+            const double alpha = std::sin(w0) / (2.0 * 0.7071067811865476);
+            const double a0 = 1.0 + alpha;
+            
+            b0 = static_cast<float>((1.0 + cosW0) * 0.5 / a0);
+            b1 = static_cast<float>(-(1.0 + cosW0) / a0);
+            b2 = b0;
+            a1 = static_cast<float>(-2.0 * cosW0 / a0);
+            a2 = static_cast<float>((1.0 - alpha) / a0);
+            
+            // Columns from the per-sample filter, so both forms agree
+            for (int j = 0; j < numStates; ++j) {
+                HFBandFilter unit;
+                unit.setState(j, 1.0f);
+                for (int k = 0; k < blockLength; ++k)
+                    stateToOutput[j][k] = unit.process(0.0f, *this);
+                unit.getState(stateToState[j]);
+            }
+            
+            for (int i = 0; i < blockLength; ++i) {
+                HFBandFilter unit;
+                for (int k = 0; k < blockLength; ++k)
+                    inputToOutput[i][k] = unit.process(k == i ? 1.0f : 0.0f, *this);
+                unit.getState(inputToState[i]);
+            }
+        }
+    };
+    
+    float process(float input, const Coefficients& c) {
+        const float y1 = c.b0 * input + s1[0];
+        s1[0] = c.b1 * input - c.a1 * y1 + s1[1];
+        s1[1] = c.b2 * input - c.a2 * y1;
+        
+        const float y2 = c.b0 * y1 + s2[0];
+        s2[0] = c.b1 * y1 - c.a1 * y2 + s2[1];
+        s2[1] = c.b2 * y1 - c.a2 * y2;
+        
+        return y2;
+    }
+    
+    // output must be SIMD aligned and may be input (the tail past the last whole block runs per sample)
+    void processBlock(const float* input, float* output, int numSamples, const Coefficients& c) {
+        constexpr int width = static_cast<int>(Vec::size());
+        constexpr int numOutputs = blockLength / width;
+        int i = 0;
+        
+        for (; i + blockLength <= numSamples; i += blockLength) {
+            // The input terms do not depend on the previous block; an input never reaches
+            // the registers holding earlier outputs (those columns are zero)
+Vec outputs[numOutputs];
+            Vec nextState = Vec::expand(0.0f);
+            
+            for (int v = 0; v < numOutputs; ++v)
+                outputs[v] = Vec::expand(0.0f);
+            
+            for (int n = 0; n < blockLength; ++n) {
+                const Vec x = Vec::expand(input[i + n]);
+                for (int v = n / width; v < numOutputs; ++v)
+                    outputs[v] = outputs[v] + x * Vec::fromRawArray(c.inputToOutput[n] + v * width);
+                nextState = nextState + x * Vec::fromRawArray(c.inputToState[n]);
+            }
+            
+            // The state terms, summed pairwise to keep the block-to-block dependency short
+            const Vec state[numStates] = { Vec::expand(s1[0]), Vec::expand(s1[1]), Vec::expand(s2[0]), Vec::expand(s2[1]) };
+            
+            for (int v = 0; v < numOutputs; ++v)
+                (outputs[v] + fromState(state, c.stateToOutput, v * width)).copyToRawArray(output + i + v * width);
+            
+            nextState = nextState + fromState(state, c.stateToState, 0);
+            s1 = { nextState.get(0), nextState.get(1) };
+            s2 = { nextState.get(2), nextState.get(3) };
+        }
+        
+        for (; i < numSamples; ++i)
+            output[i] = process(input[i], c);
+    }
+    
+    void reset() {
+        s1 = {};
+        s2 = {};
+    }
+    
+private:
+    void setState(int index, float value) { (index < 2 ? s1 : s2)[static_cast<size_t>(index % 2)] = value; }
+    void getState(float* dest) const { dest[0] = s1[0]; dest[1] = s1[1]; dest[2] = s2[0]; dest[3] = s2[1]; }
+    
+    static Vec fromState(const Vec (&state)[numStates], const float (&columns)[numStates][blockLength], int offset) {
+        return (state[0] * Vec::fromRawArray(columns[0] + offset) + state[1] * Vec::fromRawArray(columns[1] + offset))
+             + (state[2] * Vec::fromRawArray(columns[2] + offset) + state[3] * Vec::fromRawArray(columns[3] + offset));
+    }
+
+    std::array<float, 2> s1 {}, s2 {};
+};
+
 //==============================================================================
 // Simple gain processor
 class GainProcessor
@@ -184,7 +628,9 @@ public:
     void prepare(const juce::dsp::ProcessSpec& spec)
     {
         gain.setGainLinear(1.0f);
+        gain.setRampDurationSeconds(0.02); // 20ms de-zipper ramp on gain changes
         gain.prepare(spec);
+        snapToTarget = true;
     }
 
     void reset()
@@ -192,9 +638,15 @@ public:
         gain.reset();
     }
 
+    // The first gain after prepare is taken as is (no fade in from unity), later ones ramp
     void setGainLinear(float newGain)
     {
         gain.setGainLinear(newGain);
+        
+        if (snapToTarget) {
+            gain.reset(); // Jumps the smoother to its target
+            snapToTarget = false;
+        }
     }
 
     template<typename ProcessContext>
@@ -203,8 +655,28 @@ public:
         gain.process(context);
     }
 
+    // For fused processing: the gain the next sample will get when not smoothing
+    float getGainLinear() const
+    {
+        return gain.getGainLinear();
+    }
+
+    // For fused processing: writes the next numSamples ramp values into dest and
+    // advances the smoother. Returns false (dest untouched) when the gain is steady.
+    bool fillGainRamp(float* dest, int numSamples)
+    {
+        if (! gain.isSmoothing())
+            return false;
+
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = gain.processSample(1.0f);
+
+        return true;
+    }
+
 private:
     juce::dsp::Gain<float> gain;
+    bool snapToTarget = true;
 };
 
 //==============================================================================
@@ -212,54 +684,179 @@ private:
 class TransientDesigner
 {
 public:
+    // Live playback runs the lightest path; offline bounces (host isNonRealtime)
+    // oversample the final clipper stage. Both profiles are allocated in prepare,
+    // so switching never allocates, and both report the same latency: without
+    // the oversampler, stage 15 delays the audio by a fixed pad of the same length.
+    // The tape stage runs per sample inside the shaping loop and is not
+    // oversampled, and neither profile lengthens a lookahead (that would change
+    // the latency at bounce time).
+    enum class RenderQuality { REALTIME, OFFLINE };
+
+    struct QualityProfile
+    {
+        int clipperOversamplingOrder; // 2^order oversampling around stage 15
+    };
+
+    static constexpr QualityProfile getQualityProfile(RenderQuality quality)
+    {
+        return quality == RenderQuality::OFFLINE ? QualityProfile { 2 }   // 4x
+                                                 : QualityProfile { 0 };
+    }
+
     void prepare(const juce::dsp::ProcessSpec& spec)
     {
+        // Only the block size changed: keep the envelope state, nothing to rebuild
+        if (prepared && spec.sampleRate == sampleRate && static_cast<int>(spec.numChannels) == numChannels)
+            return;
+        
+        prepared = true;
         sampleRate = spec.sampleRate;
         numChannels = spec.numChannels;
         
-        // Initialize envelope followers for each channel
-        attackEnvelopes.clear();
-        sustainEnvelopes.clear();
-        dualEnvelopeDetectors.clear();
+        // Initialize Dual Envelope coefficients - continuous, no gating!
+        detectorCoeffs.prepare(sampleRate);
+        envelopeCoeffs.set_times(attackTime, releaseTime, static_cast<float>(sampleRate));
         
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            attackEnvelopes.emplace_back();
-            sustainEnvelopes.emplace_back();
-            dualEnvelopeDetectors.emplace_back();
-        }
+        onsetTrigger.prepare(sampleRate);
         
-        // Initialize Dual Envelope detectors - continuous, no gating!
-        for (auto& detector : dualEnvelopeDetectors) {
-            detector.prepare(sampleRate);
-        }
+        // HF Saturation band
+        hfBandCoeffs.prepare(sampleRate, hfBandCutoffHz);
+        
+        // Spectral-flux engine; its audio delay lives in the arena
+        lookaheadLength = SpectralFluxDetector::getLookaheadSamples(sampleRate);
+
+        // Offline-profile oversampler, built up front so a bounce never allocates;
+        // the latency pad stands in for its delay whenever it does not run
+        clipperOversampler = std::make_unique<juce::dsp::Oversampling<float>>(
+            static_cast<size_t>(numChannels),
+            static_cast<size_t>(getQualityProfile(RenderQuality::OFFLINE).clipperOversamplingOrder),
+            juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, true);
+        clipperOversampler->initProcessing(static_cast<size_t>(fusedChunkSize));
+        latencyPadLength = juce::roundToInt(clipperOversampler->getLatencyInSamples());
+        
+        // Per-channel state only - coefficients live once per instance. The spectral-flux
+        // detector and stage 15's true-peak limiter and meter carve theirs from it too
+        allocateState();
         
         reset();
     }
 
     void reset()
     {
-        for (auto& env : attackEnvelopes)
-            env.reset();
-        for (auto& env : sustainEnvelopes)
-            env.reset();
-        for (auto& detector : dualEnvelopeDetectors)
-            detector.reset();
+        for (int ch = 0; ch < numChannels && channels != nullptr; ++ch)
+            channels[ch].reset();
+        if (clipperOversampler != nullptr)
+            clipperOversampler->reset();
+        clipperOversampled = false;
+        onsetTrigger.reset();
+        spectralFlux.reset();
+        clearLookahead();
+        lookaheadPosition = 0;
+        if (latencyPadBuffer != nullptr)
+            std::fill(latencyPadBuffer, latencyPadBuffer + numChannels * latencyPadLength, 0.0f);
+        latencyPadPosition = 0;
+        truePeakLimiter.reset();
+        truePeakMeter.reset();
+        truePeakHold = 0.0f;
+        truePeakLevel.store(0.0f, std::memory_order_relaxed);
+    }
+
+    // Audio thread; the stage-15 history belongs to one rate, so it restarts
+    void setRenderQuality(RenderQuality quality)
+    {
+        if (quality == renderQuality)
+            return;
+        
+        renderQuality = quality;
+        
+        for (int ch = 0; ch < numChannels && channels != nullptr; ++ch)
+            channels[ch].adaaClipper.reset();
+        clipperOversampled = false;
+    }
+    
+    RenderQuality getRenderQuality() const { return renderQuality; }
+    
+    // Latency with the current detector engine and clipper mode, the same in both
+    // render profiles: the sum of the active stages' delays (spectral-flux
+    // lookahead, oversampler filters or the pad, true-peak lookahead). 0 before prepare.
+    int getLatencySamples() const
+    {
+        const int detectorLatency = detectorEngine == DetectorEngine::SPECTRAL_FLUX ? lookaheadLength : 0;
+        return detectorLatency + getOutputLatencySamples();
+    }
+    
+    // The part of the latency after detection (MIDI onsets are delayed by it)
+    int getOutputLatencySamples() const
+    {
+        int latency = latencyPadLength;
+        
+        if (clipperTruePeak && prepared)
+            latency += truePeakLimiter.getLatencySamples();
+        
+        return latency;
+    }
+    
+    // Largest latency any engine/mode combination can report (for sizing delay lines)
+    int getMaxLatencySamples() const
+    {
+        int latency = lookaheadLength + latencyPadLength;
+        
+        if (prepared)
+            latency += truePeakLimiter.getLatencySamples();
+        
+        return latency;
+    }
+    
+    // Audio thread; the new engine starts from clean history (latency changes with it)
+    void setDetectorEngine(DetectorEngine engine)
+    {
+        if (engine == detectorEngine)
+            return;
+        
+        detectorEngine = engine;
+        spectralFlux.reset();
+        clearLookahead();
+    }
+    
+    DetectorEngine getDetectorEngine() const { return detectorEngine; }
+    
+    // Audio thread; true-peak limiting adds a fixed lookahead (see TruePeakLimiter)
+    void setClipperTruePeak(bool enabled)
+    {
+        if (enabled == clipperTruePeak)
+            return;
+        
+        clipperTruePeak = enabled;
+        truePeakLimiter.reset();
+        truePeakMeter.reset();
+        truePeakHold = 0.0f;
+        truePeakLevel.store(0.0f, std::memory_order_relaxed);
+    }
+    
+    bool getClipperTruePeak() const { return clipperTruePeak; }
+    
+    // True-peak meter (linear) of the output, with a 0.5 s peak-hold release; any
+    // thread. Only runs in true-peak mode, 0 otherwise.
+    float getTruePeakLevel() const { return truePeakLevel.load(std::memory_order_relaxed); }
+    
+    // Bytes owned by this instance: the object itself, the state arena and the
+    // detector/true-peak buffers (the JUCE oversampler's internal buffers are not counted)
+    size_t getMemoryFootprint() const
+    {
+        return sizeof(*this) + stateArena.getSizeInBytes() + spectralFlux.getMemoryFootprint();
     }
 
     void setAttackAmount(float amount) { attackAmount = amount; }
     void setSustainAmount(float amount) { sustainAmount = amount; }
+    // Attack and sustain followers share one coefficient block (cached, see EnvelopeFollower)
     void setAttackTime(float time) { 
         attackTime = time; 
-        for (auto& env : attackEnvelopes)
-            env.set_times(time, releaseTime, sampleRate);
+        envelopeCoeffs.set_times(time, releaseTime, static_cast<float>(sampleRate));
     }
     void setReleaseTime(float time) { 
         releaseTime = time; 
-        for (auto& env : attackEnvelopes)
-            env.set_times(attackTime, time, sampleRate);
-        for (auto& env : sustainEnvelopes)
-            env.set_times(attackTime, time, sampleRate);
+        envelopeCoeffs.set_times(attackTime, time, static_cast<float>(sampleRate));
     }
     void setAttackThreshold(float threshold) { attackThreshold = threshold; }
     void setSustainThreshold(float threshold) { sustainThreshold = threshold; }
@@ -275,8 +872,17 @@ public:
     // DrumSnapper-inspired setters
     void setFocus(float amount) { focus = amount; }
     void setHFGain(float gain) { hfGain = gain; }
-    void setHFSaturation(float saturation) { hfSaturation = saturation; }
-    void setTapeClip(bool enabled) { tapeClip = enabled; }
+    void setHFSaturation(float saturation)
+    {
+        // The band filter only runs while saturating; restart it from silence, not stale history
+        if (saturation > 0.0f && hfSaturation <= 0.0f) {
+            for (int ch = 0; ch < numChannels && channels != nullptr; ++ch)
+                channels[ch].hfBand.reset();
+        }
+        
+        hfSaturation = saturation;
+    }
+void setTapeClip(bool enabled) { tapeClip = enabled; }
     void setAutoGainComp(bool enabled) { autoGainComp = enabled; }
     
     // PeakEater-style Clipper setters
@@ -284,268 +890,668 @@ public:
     void setClipperCeiling(float ceiling) { clipperCeiling = ceiling; }
     void setClipperDrive(float drive) { clipperDrive = drive; }
     void setClipperType(ClipperType type) { clipperType = type; }
+    void setClipperAntialiasing(ClipperAntialiasing order) { clipperAntialiasing = order; }
+    
+    // Realtime degradation tier, chosen per block by the processor's controller
+    void setQualityTier(QualityTier tier) { qualityTier = tier; }
+    
+    // Eco detection on request (the CONTROL_RATE tier also turns it on)
+    void setEcoDetection(bool enabled) { ecoDetection = enabled; }
+    
+    // MIDI onset output (see OnsetTrigger)
+    void setOnsetNote(int note) { onsetTrigger.setNote(note); }
+    void setOnsetThreshold(float thresholdDb) { onsetTrigger.setThreshold(thresholdDb); }
+    void setOnsetHoldTime(float ms) { onsetTrigger.setHoldTime(ms); }
+    void releaseOnsetNote(juce::MidiBuffer& midi, int position = 0) { onsetTrigger.releaseNote(midi, position); }
+    
+    // Offline: take transientDetected from a unity-gain envelope (planar, numCachedSamples
+    // per channel) instead of the detectors; reading restarts at sample 0. nullptr = live.
+    void setCachedDetectorEnvelope(const float* const* envelope, int numCachedChannels, juce::int64 numCachedSamples)
+    {
+        cachedEnvelope = envelope;
+        cachedEnvelopeChannels = numCachedChannels;
+        cachedEnvelopeLength = numCachedSamples;
+        cachedEnvelopePosition = 0;
+    }
     
     // Dual Envelope is fully automatic - no parameter setup needed!
 
+    // Bypassed: run only the detectors/followers so un-bypassing starts from live envelopes
+    template<typename Block>
+    void warmDetectors(const Block& block, float inputGain)
+    {
+        const int numSamples = static_cast<int>(block.getNumSamples());
+        const int numWarmChannels = std::min(numChannels, static_cast<int>(block.getNumChannels()));
+        linkedDetectionActive = false; // Every channel's detector runs here
+        
+        for (int ch = 0; ch < numWarmChannels; ++ch)
+        {
+            const auto* input = block.getChannelPointer(ch);
+            
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                const float x = input[sample] * inputGain;
+                
+                if (detectorEngine == DetectorEngine::SPECTRAL_FLUX) {
+                    spectralFlux.process(ch, x);
+                    lookaheadBuffer[ch * lookaheadLength + (lookaheadPosition + sample) % lookaheadLength] = x;
+                } else {
+                    detectEnvelope(channels[ch], x, controlRateActive);
+                }
+            }
+        }
+        
+        advanceBlockPositions(numSamples);
+    }
+
+    template<typename ProcessContext>
+    void process(ProcessContext& context)
+    {
+        processFused(context, nullptr, nullptr, nullptr);
+    }
+
+    // Fused single pass: input gain -> shaper -> output gain (with their smoothing
+    // ramps) in one traversal of each channel instead of three passes over the block.
+    // With onsetMidi set, detected transients are also written out as note-ons.
+    template<typename ProcessContext>
+    void process(ProcessContext& context, GainProcessor& inputGain, GainProcessor& outputGain,
+                 juce::MidiBuffer* onsetMidi = nullptr)
+    {
+        processFused(context, &inputGain, &outputGain, onsetMidi);
+    }
+
     template<typename ProcessContext>
-    void process(ProcessContext& context)
+    void processFused(ProcessContext& context, GainProcessor* inputGain, GainProcessor* outputGain,
+                      juce::MidiBuffer* onsetMidi)
     {
         auto& inputBlock = context.getInputBlock();
         auto& outputBlock = context.getOutputBlock();
+        const int numSamples = static_cast<int>(inputBlock.getNumSamples());
+        
+        const float inputGainValue = inputGain != nullptr ? inputGain->getGainLinear() : 1.0f;
+        const float outputGainValue = outputGain != nullptr ? outputGain->getGainLinear() : 1.0f;
+        const auto profile = getQualityProfile(renderQuality);
+        
+        // Realtime quality tier (AdaptiveQualityController); offline renders run FULL
+        const bool exactMath = qualityTier < QualityTier::FAST_MATH;
+        const auto antialiasing = qualityTier >= QualityTier::FAST_MATH ? ClipperAntialiasing::OFF
+                                : qualityTier >= QualityTier::REDUCED_ANTIALIASING ? std::min(clipperAntialiasing, ClipperAntialiasing::ADAA1)
+                                : clipperAntialiasing;
+        const bool linkedDetection = qualityTier >= QualityTier::LINKED_DETECTION && numChannels > 1;
+        const bool controlRate = ecoDetection || qualityTier >= QualityTier::CONTROL_RATE;
+        setLinkedDetectionActive(linkedDetection);
+        setControlRateActive(controlRate);
+        
+        // Eco detection runs ahead of the per-sample loop, one chunk per channel
+        const bool chunkDetection = controlRate && detectorEngine != DetectorEngine::SPECTRAL_FLUX
+                                    && cachedEnvelope == nullptr;
+        
+        // Stage 15 runs per chunk when clipping, and whenever it delays the audio
+        // (oversampler or latency pad, true-peak mode) so the reported latency does
+        // not depend on the clipper switch. Only a running clipper is oversampled.
+        const bool chunkFinalStage = clipperEnabled || latencyPadLength > 0 || clipperTruePeak;
+        const bool oversampleClipper = clipperEnabled && profile.clipperOversamplingOrder > 0;
+        float blockTruePeak = 0.0f;
         
-        // Debug counter for periodic output
-        static int debugSampleCounter = 0;
-        static bool debugThisBlock = false;
+        // The audio is delayed after detection (oversampler, true-peak lookahead); onsets get the same delay
+        if (onsetMidi != nullptr) {
+            onsetTrigger.setOutputDelay(getOutputLatencySamples());
+            onsetTrigger.beginBlock(*onsetMidi, numSamples);
+        }
+        
+        // Per-stage timing (empty when ATAKATAK_STAGE_PROFILER is off)
+        StageProfiler::Laps laps(profiler);
         
-        for (int ch = 0; ch < numChannels; ++ch)
+        // Chunked so the gain ramps fit fixed buffers and the clipper/output gain
+        // revisit each chunk while it is still cache-hot; state carries across chunks
+        for (int chunkStart = 0; chunkStart < numSamples; chunkStart += fusedChunkSize)
         {
-            auto* input = inputBlock.getChannelPointer(ch);
-            auto* output = outputBlock.getChannelPointer(ch);
+            const int chunkLength = std::min(fusedChunkSize, numSamples - chunkStart);
+            const int chunkEnd = chunkStart + chunkLength;
             
-            for (int sample = 0; sample < inputBlock.getNumSamples(); ++sample)
+            // Ramps are shared by every channel, so expand them once per chunk
+            const float* inputRamp = (inputGain != nullptr && inputGain->fillGainRamp(scratch->inputGainRamp.data(), chunkLength))
+                                         ? scratch->inputGainRamp.data() : nullptr;
+            const float* outputRamp = (outputGain != nullptr && outputGain->fillGainRamp(scratch->outputGainRamp.data(), chunkLength))
+                                          ? scratch->outputGainRamp.data() : nullptr;
+            
+            for (int ch = 0; ch < numChannels; ++ch)
             {
-                float inputSample = input[sample];
+                auto* input = inputBlock.getChannelPointer(ch);
+                auto* output = outputBlock.getChannelPointer(ch);
+                auto& state = channels[ch];
+                
+                // Eco detection for the whole chunk (linked: channel 0 on the channel peak)
+                const float* chunkStrength = nullptr;
                 
-                // Debug output every 44100 samples (1 second at 44.1kHz)
-                if (++debugSampleCounter >= 44100) {
-                    debugSampleCounter = 0;
-                    debugThisBlock = (ch == 0 && sample == 0); // Only debug first channel, first sample
+                if (chunkDetection) {
+                    laps.start();
+                    float* detectorInput = scratch->detectorInput.data();
+                    
+                    if (linkedDetection) {
+                        if (ch == 0) {
+                            juce::FloatVectorOperations::abs(detectorInput, input + chunkStart, chunkLength);
+                            for (int other = 1; other < numChannels; ++other) {
+                                juce::FloatVectorOperations::abs(scratch->detectorStrength.data(), inputBlock.getChannelPointer(other) + chunkStart, chunkLength);
+                                juce::FloatVectorOperations::max(detectorInput, detectorInput, scratch->detectorStrength.data(), chunkLength);
+                            }
+                            applyInputGain(detectorInput, inputRamp, inputGainValue, chunkLength);
+                            detectControlRate(state, detectorInput, scratch->linkedStrength.data(), chunkLength, false);
+                        }
+                        
+                        chunkStrength = scratch->linkedStrength.data();
+                    } else {
+                        juce::FloatVectorOperations::copy(detectorInput, input + chunkStart, chunkLength);
+                        applyInputGain(detectorInput, inputRamp, inputGainValue, chunkLength);
+                        detectControlRate(state, detectorInput, scratch->detectorStrength.data(), chunkLength, true);
+                        chunkStrength = scratch->detectorStrength.data();
+                    }
+                    
+                    laps.mark(ProfilerStage::DETECTION);
                 }
+            
+                laps.startSamples();
                 
-                // 1. DUAL ENVELOPE Transient Detection - CONTINUOUS, NO GATING!
-                float transientDetected = dualEnvelopeDetectors[ch].process(inputSample);
+                // HF Saturation splits the loop: stages 1-10 store the shaped chunk, the
+                // band filter runs over it in blocks, stages 12-14 finish it below
+                const bool hfChunkStage = hfSaturation > 0.0f;
                 
-                // For envelope followers, use traditional method for attack/sustain shaping
-                float attackEnv = attackEnvelopes[ch].process(inputSample);
-                float sustainEnv = sustainEnvelopes[ch].process(inputSample);
+                for (int sample = chunkStart; sample < chunkEnd; ++sample)
+                {
+                    // Input gain folded into the load
+                    const float sampleInputGain = inputRamp != nullptr ? inputRamp[sample - chunkStart] : inputGainValue;
+                    float inputSample = input[sample] * sampleInputGain;
                 
-                if (debugThisBlock) {
-                    std::cout << "=== DUAL ENVELOPE MODE ===" << std::endl;
-                    std::cout << "Input: " << inputSample << ", Transient: " << transientDetected 
-                              << ", Fast: " << dualEnvelopeDetectors[ch].getFastEnvelope()
-                              << ", Slow: " << dualEnvelopeDetectors[ch].getSlowEnvelope() << std::endl;
-                }
+                    laps.startSample();
                 
-                // 4. Calculate gains
-                float attackGain = 1.0f;
-                float sustainGain = 1.0f;
+                    // 1. DUAL ENVELOPE Transient Detection - CONTINUOUS, NO GATING!
+                    float transientDetected;
                 
-                if (attackAmount > 0.0f)
-                {
-                    // Boost attack - sensitivity only affects detection, not gain!
-                    float attackScale = (attackAmount / 100.0f); // Remove sensitivity from gain calculation
-                    attackGain = 1.0f + attackScale * 3.0f * transientDetected; // Stronger base effect
-                }
-                else if (attackAmount < 0.0f)
-                {
-                    // Reduce attack - sensitivity only affects detection, not gain!
-                    float attackReduction = (-attackAmount / 100.0f); // Remove sensitivity from gain calculation
-                    attackGain = 1.0f / (1.0f + attackReduction * 3.0f * transientDetected); // Stronger base effect
-                }
+                    if (detectorEngine == DetectorEngine::SPECTRAL_FLUX) {
+                        // Always per channel: the eco and linked tiers only cheapen the Envelope engine.
+                        // The detector sees the live input; the shaping reads it lookaheadLength
+                        // samples later so onsets line up with the interpolated flux
+                        transientDetected = spectralFlux.process(ch, inputSample);
+                        
+                        float& delayed = lookaheadBuffer[ch * lookaheadLength + (lookaheadPosition + sample) % lookaheadLength];
+                        std::swap(inputSample, delayed);
+                    } else if (cachedEnvelope != nullptr) {
+                        // Offline cache (unity gain; the detector scales with its input).
+                        // Past the end of the file the envelope has decayed to zero.
+                        const juce::int64 index = cachedEnvelopePosition + sample;
+                        const float* envelope = cachedEnvelope[std::min(ch, cachedEnvelopeChannels - 1)];
+                        transientDetected = index < cachedEnvelopeLength ? envelope[index] * sampleInputGain : 0.0f;
+                    } else if (chunkStrength != nullptr) {
+                        transientDetected = chunkStrength[sample - chunkStart];
+                    } else if (linkedDetection) {
+                        // One detector on the channel peak: channel 0 runs it, the others reuse it
+                        float& linked = scratch->linkedStrength[static_cast<size_t>(sample - chunkStart)];
+                        
+                        if (ch == 0) {
+                            float peak = std::abs(inputSample);
+                            for (int other = 1; other < numChannels; ++other)
+                                peak = std::max(peak, std::abs(inputBlock.getChannelPointer(other)[sample] * sampleInputGain));
+                            linked = channels[0].detector.process(peak, detectorCoeffs);
+                        }
+                        
+                        transientDetected = linked;
+                    } else {
+                        transientDetected = detectEnvelope(state, inputSample, controlRate);
+                    }
                 
-                if (sustainAmount > 0.0f)
-                {
-                    // Boost sustain - sensitivity only affects detection, not gain!
-                    float sustainScale = (sustainAmount / 100.0f); // Remove sensitivity from gain calculation
-                    sustainGain = 1.0f + sustainScale * 3.0f; // Stronger base effect
-                }
-                else if (sustainAmount < 0.0f)
-                {
-                    // Reduce sustain - sensitivity only affects detection, not gain!
-                    float sustainReduction = (-sustainAmount / 100.0f); // Remove sensitivity from gain calculation
-                    sustainGain = 1.0f / (1.0f + sustainReduction * 3.0f); // Stronger base effect
-                }
+                    // Channel-linked strength for the MIDI trigger
+                    if (onsetMidi != nullptr) {
+                        float& strength = scratch->onsetStrength[static_cast<size_t>(sample - chunkStart)];
+                        strength = ch == 0 ? transientDetected : std::max(strength, transientDetected);
+                    }
                 
-                if (debugThisBlock) {
-                    std::cout << "Attack Amount: " << attackAmount << " -> Gain: " << attackGain << std::endl;
-                    std::cout << "Sustain Amount: " << sustainAmount << " -> Gain: " << sustainGain << std::endl;
-                    std::cout << "Dual Envelope Continuous, TransientDetected: " << transientDetected << std::endl;
-                }
+                    laps.mark(ProfilerStage::DETECTION);
+                
+                    // 4. Calculate gains
+                    float attackGain = 1.0f;
+                    float sustainGain = 1.0f;
+                
+                    if (attackAmount > 0.0f)
+                    {
+                        // Boost attack - sensitivity only affects detection, not gain!
+                        float attackScale = (attackAmount / 100.0f); // Remove sensitivity from gain calculation
+                        attackGain = 1.0f + attackScale * 3.0f * transientDetected; // Stronger base effect
+                    }
+                    else if (attackAmount < 0.0f)
+                    {
+                        // Reduce attack - sensitivity only affects detection, not gain!
+                        float attackReduction = (-attackAmount / 100.0f); // Remove sensitivity from gain calculation
+                        attackGain = 1.0f / (1.0f + attackReduction * 3.0f * transientDetected); // Stronger base effect
+                    }
+                
+                    if (sustainAmount > 0.0f)
+                    {
+                        // Boost sustain - sensitivity only affects detection, not gain!
+                        float sustainScale = (sustainAmount / 100.0f); // Remove sensitivity from gain calculation
+                        sustainGain = 1.0f + sustainScale * 3.0f; // Stronger base effect
+                    }
+                    else if (sustainAmount < 0.0f)
+                    {
+                        // Reduce sustain - sensitivity only affects detection, not gain!
+                        float sustainReduction = (-sustainAmount / 100.0f); // Remove sensitivity from gain calculation
+                        sustainGain = 1.0f / (1.0f + sustainReduction * 3.0f); // Stronger base effect
+                    }
                 
-                // 5. Apply psychoacoustic weighting
-                float psychoacousticWeight = 1.0f + (criticalBandWeight - 1.0f) * transientDetected;
-                attackGain *= psychoacousticWeight;
-                sustainGain *= (1.0f + (temporalWeight - 1.0f) * (1.0f - transientDetected));
+                    // 5. Apply psychoacoustic weighting
+                    float psychoacousticWeight = 1.0f + (criticalBandWeight - 1.0f) * transientDetected;
+                    attackGain *= psychoacousticWeight;
+                    sustainGain *= (1.0f + (temporalWeight - 1.0f) * (1.0f - transientDetected));
                 
-                // 6. Apply SNAP processing (Variable Hardness Waveshaper from compendium) - SAFE
-                float snapGain = 1.0f;
-                if (snapAmount > 0.0f) {
-                    // Normalize transientDetected to reasonable range [0,1] for dual envelope
-                    float normalizedTransient = std::min(1.0f, transientDetected * 5.0f); // Less aggressive scaling
+                    laps.mark(ProfilerStage::GAINS);
+                
+                    // 6. Apply SNAP processing (Variable Hardness Waveshaper from compendium) - SAFE
+                    float snapGain = 1.0f;
+                    if (snapAmount > 0.0f) {
+                        // Normalize transientDetected to reasonable range [0,1] for dual envelope
+                        float normalizedTransient = std::min(1.0f, transientDetected * 5.0f); // Less aggressive scaling
                     
-                    // More conservative SNAP input to prevent overdriving
-                    float snapInput = snapAmount / 100.0f * (0.2f + normalizedTransient * 0.5f); // Base 20% + smaller boost
-                    snapGain = processSnapWaveshaper(snapInput);
+                        // More conservative SNAP input to prevent overdriving
+                        float snapInput = snapAmount / 100.0f * (0.2f + normalizedTransient * 0.5f); // Base 20% + smaller boost
+                        snapGain = processSnapWaveshaper(snapInput);
                     
-                    // Limit SNAP gain to prevent excessive boost
-                    snapGain = std::min(2.0f, snapGain); // Max 2x gain
-                }
-                attackGain *= snapGain;
+                        // Limit SNAP gain to prevent excessive boost
+                        snapGain = std::min(2.0f, snapGain); // Max 2x gain
+                    }
+                    attackGain *= snapGain;
                 
-                // Apply SNAP to sustain as well for stronger effect - LIMITED
-                float sustainSnapGain = 1.0f;
-                if (snapAmount > 0.0f) {
-                    float sustainSnapInput = snapAmount / 300.0f; // Even gentler for sustain
-                    sustainSnapGain = processSnapWaveshaper(sustainSnapInput);
+                    // Apply SNAP to sustain as well for stronger effect - LIMITED
+                    float sustainSnapGain = 1.0f;
+                    if (snapAmount > 0.0f) {
+                        float sustainSnapInput = snapAmount / 300.0f; // Even gentler for sustain
+                        sustainSnapGain = processSnapWaveshaper(sustainSnapInput);
                     
-                    // Limit sustain SNAP gain even more
-                    sustainSnapGain = std::min(1.3f, sustainSnapGain); // Max 30% boost for sustain
-                }
-                sustainGain *= sustainSnapGain;
-                
-                if (debugThisBlock && snapAmount > 0.0f) {
-                    float normalizedTransient = std::min(1.0f, transientDetected * 10.0f);
-                    float snapInput = snapAmount / 100.0f * (0.3f + normalizedTransient * 0.7f);
-                    std::cout << "SNAP Debug: Amount=" << snapAmount 
-                              << ", TransientDetected=" << transientDetected 
-                              << ", NormalizedTransient=" << normalizedTransient
-                              << ", SnapInput=" << snapInput
-                              << ", SnapGain=" << snapGain << std::endl;
-                }
+                        // Limit sustain SNAP gain even more
+                        sustainSnapGain = std::min(1.3f, sustainSnapGain); // Max 30% boost for sustain
+                    }
+                    sustainGain *= sustainSnapGain;
                 
-                // 7. Apply harmonic enhancement (Neve transformer style from compendium) - 3x stronger
-                if (harmonicEnhancement > 0.0f) {
-                    // Always apply harmonic enhancement when > 0, but scale with transient detection
-                    float harmonicScale = 0.1f + transientDetected * 0.9f;
-                    float harmonicContent = attackGain * attackGain * 0.3f; // 3x stronger
-                    attackGain += harmonicContent * harmonicEnhancement * 0.06f * harmonicScale; // 3x stronger
-                }
+                    laps.mark(ProfilerStage::SNAP);
                 
-                // Apply harmonic enhancement to sustain as well - 3x stronger
-                if (harmonicEnhancement > 0.0f) { // Remove sustainAmount > 0.0f condition - Harmonics should work independently
-                    float sustainHarmonicContent = sustainGain * sustainGain * 0.15f; // 3x stronger for sustain
-                    sustainGain += sustainHarmonicContent * harmonicEnhancement * 0.03f; // 3x stronger
-                }
+                    // 7. Apply harmonic enhancement (Neve transformer style from compendium) - 3x stronger
+                    if (harmonicEnhancement > 0.0f) {
+                        // Always apply harmonic enhancement when > 0, but scale with transient detection
+                        float harmonicScale = 0.1f + transientDetected * 0.9f;
+                        float harmonicContent = attackGain * attackGain * 0.3f; // 3x stronger
+                        attackGain += harmonicContent * harmonicEnhancement * 0.06f * harmonicScale; // 3x stronger
+                    }
                 
-                // 8. Apply Focus (DrumSnapper-inspired) - sharpen attack 
-                if (focus > 1.0f) {
-                    attackGain *= focus;
-                }
+                    // Apply harmonic enhancement to sustain as well - 3x stronger
+                    if (harmonicEnhancement > 0.0f) { // Remove sustainAmount > 0.0f condition - Harmonics should work independently
+                        float sustainHarmonicContent = sustainGain * sustainGain * 0.15f; // 3x stronger for sustain
+                        sustainGain += sustainHarmonicContent * harmonicEnhancement * 0.03f; // 3x stronger
+                    }
+                
+                    // 8. Apply Focus (DrumSnapper-inspired) - sharpen attack 
+                    if (focus > 1.0f) {
+                        attackGain *= focus;
+                    }
                 
-                // 8.5. SAFETY LIMITING - prevent extreme values
-                attackGain = std::max(0.1f, std::min(5.0f, attackGain));   // Limit attack gain
-                sustainGain = std::max(0.1f, std::min(3.0f, sustainGain)); // Limit sustain gain
+                    // 8.5. SAFETY LIMITING - prevent extreme values
+                    attackGain = std::max(0.1f, std::min(5.0f, attackGain));   // Limit attack gain
+                    sustainGain = std::max(0.1f, std::min(3.0f, sustainGain)); // Limit sustain gain
                 
-                if (debugThisBlock) {
-                    std::cout << "Final Attack Gain: " << attackGain << ", Final Sustain Gain: " << sustainGain << std::endl;
-                    std::cout << "Focus: " << focus << ", HF Saturation: " << hfSaturation 
-                              << ", Tape Clip: " << (tapeClip ? "ON" : "OFF") << std::endl;
-                }
+                    laps.mark(ProfilerStage::HARMONICS);
                 
-                // 9. Apply processing - DrumSnapper-style mixing for stronger effects
-                float attackComponent, sustainComponent;
-                
-                if (attackAmount > 0.0f) {
-                    // Safe exponential gain for attack (like DrumSnapper)
-                    float expValue = std::max(-5.0f, std::min(5.0f, (attackGain - 1.0f))); // Clamp to safe range!
-                    float expGain = powf(2.0f, expValue);
-                    attackComponent = ((inputSample * expGain) - inputSample) * 2.0f; // Back to 2x for safety
-                } else if (attackAmount < 0.0f) {
-                    // Reduce attack - apply to all detected transients, not just strong ones
-                    attackComponent = inputSample * attackGain;
-                } else {
-                    attackComponent = 0.0f;
-                }
+                    // 9. Apply processing - DrumSnapper-style mixing for stronger effects
+                    float attackComponent, sustainComponent;
                 
-                // Sustain component (always present)
-                sustainComponent = inputSample * sustainGain;
+                    if (attackAmount > 0.0f) {
+                        // Safe exponential gain for attack (like DrumSnapper)
+                        float expValue = std::max(-5.0f, std::min(5.0f, (attackGain - 1.0f))); // Clamp to safe range!
+                        float expGain = powf(2.0f, expValue);
+                        attackComponent = ((inputSample * expGain) - inputSample) * 2.0f; // Back to 2x for safety
+                    } else if (attackAmount < 0.0f) {
+                        // Reduce attack - apply to all detected transients, not just strong ones
+                        attackComponent = inputSample * attackGain;
+                    } else {
+                        attackComponent = 0.0f;
+                    }
                 
-                // 10. Physical Sustain Shaping (multiband-transient-shaper style)
-                // sustainEnv = 1 - attackEnv for physical decay control
-                float physicalSustainEnv = 1.0f - transientDetected;
+                    // Sustain component (always present)
+                    sustainComponent = inputSample * sustainGain;
                 
-                // Apply sustain amount to envelope shape (not just gain)
-                if (sustainAmount < 0.0f) {
-                    // Negative sustain: physically shorten the decay
-                    float sustainReduction = (-sustainAmount / 100.0f); // 0 to 1
-                    physicalSustainEnv = std::pow(physicalSustainEnv, 1.0f + sustainReduction * 3.0f); // Exponential decay
-                }
+                    // 10. Physical Sustain Shaping (multiband-transient-shaper style)
+                    // sustainEnv = 1 - attackEnv for physical decay control
+                    float physicalSustainEnv = 1.0f - transientDetected;
                 
-                // 11. Mix based on transient detection - with physical sustain shaping
-                float processedSample;
-                if (transientDetected > 0.05f) { // Lower threshold - attack works more often!
-                    // During transients: add attack to sustain
-                    float attackMix = std::min(1.0f, transientDetected * 2.0f); // More aggressive attack mixing
-                    processedSample = sustainComponent + (attackComponent * attackMix);
-                } else {
-                    // During sustain: apply physical envelope shaping BUT keep sustain gain!
-                    float finalSustainComponent = sustainComponent; // Keep the gain effect
-                    
-                    // Apply physical shaping only for negative sustain
+                    // Apply sustain amount to envelope shape (not just gain)
                     if (sustainAmount < 0.0f) {
-                        finalSustainComponent *= physicalSustainEnv; // Physical shortening
+                        // Negative sustain: physically shorten the decay
+                        float sustainReduction = (-sustainAmount / 100.0f); // 0 to 1
+                        physicalSustainEnv = std::pow(physicalSustainEnv, 1.0f + sustainReduction * 3.0f); // Exponential decay
                     }
+                
+                    // 11. Mix based on transient detection - with physical sustain shaping
+                    float processedSample;
+                    if (transientDetected > 0.05f) { // Lower threshold - attack works more often!
+                        // During transients: add attack to sustain
+                        float attackMix = std::min(1.0f, transientDetected * 2.0f); // More aggressive attack mixing
+                        processedSample = sustainComponent + (attackComponent * attackMix);
+                    } else {
+                        // During sustain: apply physical envelope shaping BUT keep sustain gain!
+                        float finalSustainComponent = sustainComponent; // Keep the gain effect
                     
-                    processedSample = finalSustainComponent;
-                }
+                        // Apply physical shaping only for negative sustain
+                        if (sustainAmount < 0.0f) {
+                            finalSustainComponent *= physicalSustainEnv; // Physical shortening
+                        }
+                    
+                        processedSample = finalSustainComponent;
+                    }
+                
+                    laps.mark(ProfilerStage::SHAPING);
+                
+                    // 11. HF Saturation runs per chunk below
+                    if (hfChunkStage) {
+                        scratch->shapedSample[static_cast<size_t>(sample - chunkStart)] = processedSample;
+                        scratch->drySample[static_cast<size_t>(sample - chunkStart)] = inputSample;
+                        continue;
+                    }
+                
+                    // 12-14. Tape clipper, mix, auto gain
+                    float mixedSample = processOutputStages(inputSample, processedSample, exactMath, laps);
                 
-                // 11. Apply HF Saturation (DrumSnapper-inspired)
-                if (hfSaturation > 0.0f) {
-                    // Simple high-frequency enhancement
-                    float hfContent = processedSample * processedSample * hfGain;
-                    processedSample += hfContent * (hfSaturation / 100.0f) * 0.3f;
+                    // 15. PeakEater-style Clipper runs per chunk below (TRUE FINAL STAGE)
+                
+                    // Output gain folded into the store (after the clipper when it runs per chunk)
+                    if (! chunkFinalStage)
+                        mixedSample *= (outputRamp != nullptr ? outputRamp[sample - chunkStart] : outputGainValue);
+                
+                    output[sample] = mixedSample;
                 }
                 
-                // 12. Apply Tape Clipper (DrumSnapper-inspired)
-                if (tapeClip) {
-                    processedSample = processTapeClipper(processedSample);
+                if (hfChunkStage) {
+                    laps.endSamples();
+                    
+                    // 11. Apply HF Saturation (DrumSnapper-inspired): odd saturator on the high
+                    // band only, no DC, no low-frequency IMD
+                    laps.start();
+                    float* shaped = scratch->shapedSample.data();
+                    float* hfBand = scratch->hfBand.data();
+                    const float hfAmount = (hfSaturation / 100.0f) * 0.3f;
+                    
+                    state.hfBand.processBlock(shaped, hfBand, chunkLength, hfBandCoeffs);
+                    
+                    for (int i = 0; i < chunkLength; ++i)
+                        shaped[i] += saturate(hfBand[i] * hfGain, exactMath) * hfAmount;
+                    
+                    laps.mark(ProfilerStage::HF_SATURATION);
+                    
+                    // 12-15. As in the fused loop
+                    laps.startSamples();
+                    
+                    for (int i = 0; i < chunkLength; ++i) {
+                        laps.startSample();
+                        float mixedSample = processOutputStages(scratch->drySample[static_cast<size_t>(i)], shaped[i], exactMath, laps);
+                        
+                        if (! chunkFinalStage)
+                            mixedSample *= (outputRamp != nullptr ? outputRamp[i] : outputGainValue);
+                        
+                        output[chunkStart + i] = mixedSample;
+                    }
                 }
                 
-                // 13. Apply mix control with safety limiting
-                float mixedSample = inputSample * (1.0f - mix) + processedSample * mix;
+                laps.endSamples();
+            }
+            
+            if (onsetMidi != nullptr)
+                onsetTrigger.process(scratch->onsetStrength.data(), chunkLength, chunkStart, *onsetMidi);
+            
+            // 15. Apply PeakEater-style Clipper over the chunk (oversampled in the offline
+            // profile, otherwise followed by the latency pad), then output gain while the
+            // chunk is still in L1, then true-peak limiting in true-peak mode
+            if (chunkFinalStage) {
+                laps.start();
                 
-                // 13.5. FINAL SAFETY LIMITING - prevent clipping
-                mixedSample = std::max(-2.0f, std::min(2.0f, mixedSample)); // Hard limit to prevent extreme values
+                auto chunk = outputBlock.getSubsetChannelBlock(0, static_cast<size_t>(numChannels))
+                                        .getSubBlock(static_cast<size_t>(chunkStart), static_cast<size_t>(chunkLength));
                 
-                // 14. Automatic Gain Compensation (Pirkle style)
-                if (autoGainComp) {
-                    // Calculate input and output RMS for gain compensation
-                    inputRMS = rmsCoeff * inputRMS + (1.0f - rmsCoeff) * (inputSample * inputSample);
-                    float tempOutputRMS = rmsCoeff * outputRMS + (1.0f - rmsCoeff) * (mixedSample * mixedSample);
-                    outputRMS = tempOutputRMS;
+                if (oversampleClipper) {
+                    // Filter history from before the clipper was last off is stale
+                    if (! clipperOversampled)
+                        clipperOversampler->reset();
+                    clipperOversampled = true;
                     
-                    // Calculate makeup gain to match input level
-                    float makeupGain = 1.0f;
-                    if (outputRMS > 1e-10f && inputRMS > 1e-10f) {
-                        makeupGain = std::sqrt(inputRMS / outputRMS);
-                        makeupGain = std::max(0.1f, std::min(3.0f, makeupGain)); // Limit makeup gain
-                    }
+                    // The pad keeps the unclipped tail so it can take over seamlessly
+                    processLatencyPad(chunk, false);
+                    auto upsampled = clipperOversampler->processSamplesUp(chunk);
+                    processClipperBlock(upsampled, antialiasing);
+                    clipperOversampler->processSamplesDown(chunk);
+                } else {
+                    clipperOversampled = false;
+                    processClipperBlock(chunk, antialiasing);
+                    processLatencyPad(chunk, true);
+                }
+
+                for (int ch = 0; ch < numChannels; ++ch) {
+                    auto* output = outputBlock.getChannelPointer(ch) + chunkStart;
                     
-                    mixedSample *= makeupGain;
+                    if (outputRamp != nullptr)
+                        juce::FloatVectorOperations::multiply(output, outputRamp, chunkLength);
+                    else
+                        juce::FloatVectorOperations::multiply(output, outputGainValue, chunkLength);
                 }
                 
-                // 15. Apply PeakEater-style Clipper (TRUE FINAL STAGE - like PeakEater!)
-                if (clipperEnabled) {
-                    mixedSample = processClipper(mixedSample, clipperCeiling, clipperDrive, clipperType);
+                // Intersample peaks: linked lookahead gain against the same ceiling, after the
+                // output gain so the ceiling holds for what leaves the plugin (the delay runs
+                // with the clipper off too, keeping the latency fixed)
+                if (clipperTruePeak) {
+                    truePeakLimiter.process(chunk, clipperCeiling, clipperEnabled);
+                    
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        blockTruePeak = std::max(blockTruePeak, juce::FloatVectorOperations::findMaximum(
+                                                     truePeakMeter.process(ch, outputBlock.getChannelPointer(ch) + chunkStart, chunkLength),
+                                                     chunkLength));
                 }
                 
-                output[sample] = mixedSample;
-                
-                if (debugThisBlock) {
-                    std::cout << "Attack Component: " << attackComponent << ", Sustain Component: " << sustainComponent << std::endl;
-                    std::cout << "Physical Sustain Env: " << physicalSustainEnv << std::endl;
-                    std::cout << "Processed Sample: " << processedSample << ", Final Output: " << output[sample] << std::endl;
-                    std::cout << "Mix: " << mix << ", Auto Gain Comp: " << (autoGainComp ? "ON" : "OFF") << std::endl;
-                    if (autoGainComp) {
-                        std::cout << "Input RMS: " << std::sqrt(inputRMS) << ", Output RMS: " << std::sqrt(outputRMS) << std::endl;
-                    }
-                    std::cout << "===================" << std::endl;
-                    debugThisBlock = false; // Only debug once per second
-                }
+                laps.mark(ProfilerStage::CLIPPER);
             }
         }
+        
+        advanceBlockPositions(numSamples);
+        profiler.publish(laps);
+        
+        if (clipperTruePeak) {
+            const auto release = static_cast<float>(std::exp(-numSamples / (sampleRate * truePeakReleaseSeconds)));
+            truePeakHold = std::max(blockTruePeak, truePeakHold * release);
+            truePeakLevel.store(truePeakHold, std::memory_order_relaxed);
+        }
     }
+    
+    // Per-stage counters, readable from any thread (all zero unless ATAKATAK_STAGE_PROFILER)
+    const StageProfiler& getStageProfiler() const { return profiler; }
 
 private:
+    static constexpr int fusedChunkSize = 256;
+    
+    // Hot per-channel state, everything the per-sample loop writes for one channel.
+    // Each channel starts on its own cache line.
+    struct alignas(StateArena::cacheLineSize) ChannelState
+    {
+        DualEnvelopeDetector detector;       // SPL Differential Envelope follower
+        EnvelopeFollower attackEnvelope;     // Envelope followers from compendium
+        EnvelopeFollower sustainEnvelope;
+        HFBandFilter hfBand;                 // HF Saturation band split
+        ADAAClipper adaaClipper;             // Anti-aliased clipper history
+        
+        void reset()
+        {
+            detector.reset();
+            attackEnvelope.reset();
+            sustainEnvelope.reset();
+            hfBand.reset();
+            adaaClipper.reset();
+        }
+    };
+    
+    // Per-chunk scratch shared by all channels
+    struct alignas(StateArena::cacheLineSize) ChunkScratch
+    {
+        std::array<float, fusedChunkSize> inputGainRamp;   // Fused gain ramps
+        std::array<float, fusedChunkSize> outputGainRamp;
+        std::array<float, fusedChunkSize> onsetStrength;   // MIDI onset output: linked strength
+        std::array<float, fusedChunkSize> linkedStrength;  // LINKED_DETECTION tier: shared strength
+        std::array<float, fusedChunkSize> detectorInput;   // Eco detection: gained input, strength
+        std::array<float, fusedChunkSize> detectorStrength;
+        std::array<float, fusedChunkSize> shapedSample;    // HF Saturation: stage 10 output, its
+        std::array<float, fusedChunkSize> drySample;       // input and the high band
+        std::array<float, fusedChunkSize> hfBand;
+    };
+    
+    // Lays the hot state out in the arena: channel states, chunk scratch, lookahead
+    // and latency-pad rings
+    void allocateState()
+    {
+        const auto channelCount = static_cast<size_t>(numChannels);
+        const auto lookaheadCount = channelCount * static_cast<size_t>(lookaheadLength);
+        const auto latencyPadCount = channelCount * static_cast<size_t>(latencyPadLength);
+        
+        stateArena.allocate(StateArena::bytesFor<ChannelState>(channelCount)
+                            + StateArena::bytesFor<ChunkScratch>(1)
+                            + StateArena::bytesFor<float>(lookaheadCount)
+                            + StateArena::bytesFor<float>(latencyPadCount)
+                            + SpectralFluxDetector::getStateBytes(sampleRate, numChannels)
+                            + TruePeakLimiter::getStateBytes(sampleRate, numChannels, fusedChunkSize)
+                            + TruePeakInterpolator::getStateBytes(numChannels, fusedChunkSize));
+        
+        channels = stateArena.create<ChannelState>(channelCount);
+        scratch = stateArena.create<ChunkScratch>(1);
+        lookaheadBuffer = stateArena.create<float>(lookaheadCount);
+        latencyPadBuffer = stateArena.create<float>(latencyPadCount);
+        spectralFlux.prepare(sampleRate, numChannels, stateArena);
+        truePeakLimiter.prepare(sampleRate, numChannels, fusedChunkSize, stateArena);
+        truePeakMeter.prepare(numChannels, fusedChunkSize, stateArena);
+    }
+    
+    // Envelope engine for one channel: the transient detector plus the attack/sustain
+    // followers, at audio rate or in eco detection
+    float detectEnvelope(ChannelState& state, float x, bool controlRate)
+    {
+        if (controlRate) {
+            float strength;
+            detectControlRate(state, &x, &strength, 1, true);
+            return strength;
+        }
+        
+        // For envelope followers, use traditional method for attack/sustain shaping
+        state.attackEnvelope.process(x, envelopeCoeffs);
+        state.sustainEnvelope.process(x, envelopeCoeffs);
+        return state.detector.process(x, detectorCoeffs);
+    }
+    
+    // Eco detection over a run of samples: the detector one control interval at a
+    // time, and with withFollowers the attack/sustain followers stepping once per
+    // completed interval on the detector's decimated level
+    void detectControlRate(ChannelState& state, const float* x, float* strength, int numSamples, bool withFollowers)
+    {
+        for (int done = 0; done < numSamples;) {
+            done += state.detector.processControlRate(x + done, strength + done, numSamples - done, detectorCoeffs);
+            
+            if (withFollowers && state.detector.isControlStep()) {
+                state.attackEnvelope.processControlStep(state.detector.getIntervalLevel(), envelopeCoeffs);
+                state.sustainEnvelope.processControlStep(state.detector.getIntervalLevel(), envelopeCoeffs);
+            }
+        }
+    }
+    
+    static void applyInputGain(float* x, const float* inputRamp, float inputGainValue, int numSamples)
+    {
+        if (inputRamp != nullptr)
+            juce::FloatVectorOperations::multiply(x, inputRamp, numSamples);
+        else if (inputGainValue != 1.0f)
+            juce::FloatVectorOperations::multiply(x, inputGainValue, numSamples);
+    }
+    
+    // Leaving linked detection: the other channels' detectors stopped when it began,
+    // so they continue from channel 0's, which tracked the channel peak meanwhile
+    void setLinkedDetectionActive(bool active)
+    {
+        if (! active && linkedDetectionActive) {
+            for (int ch = 1; ch < numChannels; ++ch)
+                channels[ch].detector = channels[0].detector;
+        }
+        
+        linkedDetectionActive = active;
+    }
+    
+    // Entering eco detection picks up from the audio-rate envelopes
+    void setControlRateActive(bool active)
+    {
+        if (active && ! controlRateActive) {
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch].detector.enterControlRate();
+        }
+        
+        controlRateActive = active;
+    }
+    
+    void clearLookahead()
+    {
+        if (lookaheadBuffer != nullptr)
+            std::fill(lookaheadBuffer, lookaheadBuffer + numChannels * lookaheadLength, 0.0f);
+    }
+    
+    //==============================================================================
+    // Hot state: arena regions (sized in prepare) and the per-block counters
+    StateArena stateArena;
+    ChannelState* channels = nullptr;
+    ChunkScratch* scratch = nullptr;
+    float* lookaheadBuffer = nullptr; // numChannels x lookaheadLength rings
+    int lookaheadLength = 0;
+    int lookaheadPosition = 0;
+    float* latencyPadBuffer = nullptr; // numChannels x latencyPadLength rings
+    int latencyPadLength = 0;          // The oversampler's latency, rounded
+    int latencyPadPosition = 0;
+juce::int64 cachedEnvelopePosition = 0;
+    
+    // Shared coefficient blocks, read every sample
+    EnvelopeFollower::Coefficients envelopeCoeffs;
+    DualEnvelopeDetector::Coefficients detectorCoeffs;
+    HFBandFilter::Coefficients hfBandCoeffs;
+    
+    //==============================================================================
+    // Cold configuration: layout, engines and parameters, written per block at most
     double sampleRate = 44100.0;
     int numChannels = 2;
+    bool prepared = false;
+    
+    static constexpr double hfBandCutoffHz = 4000.0;
+    
+    OnsetTrigger onsetTrigger;
+    
+    // Offline detector cache (see DetectorEnvelopeCache); nullptr = live detection
+    const float* const* cachedEnvelope = nullptr;
+    int cachedEnvelopeChannels = 0;
+    juce::int64 cachedEnvelopeLength = 0;
     
-    // Envelope followers from compendium
-    std::vector<EnvelopeFollower> attackEnvelopes;
-    std::vector<EnvelopeFollower> sustainEnvelopes;
+    // Render quality (see QualityProfile); the oversampler serves the offline profile
+    RenderQuality renderQuality = RenderQuality::REALTIME;
+    QualityTier qualityTier = QualityTier::FULL;
+    bool ecoDetection = false;
+    bool controlRateActive = false; // Eco detection ran in the last block
+    bool linkedDetectionActive = false; // Only channel 0's detector ran in the last block
     
-    // SPL Differential Envelope followers
-    std::vector<DualEnvelopeDetector> dualEnvelopeDetectors;
+    // Detector engine; spectral flux delays the audio path by lookaheadLength
+    DetectorEngine detectorEngine = DetectorEngine::ENVELOPE;
+    SpectralFluxDetector spectralFlux;
+    
+    std::unique_ptr<juce::dsp::Oversampling<float>> clipperOversampler;
+    bool clipperOversampled = false; // The oversampler ran on the last chunk
+
+    // True-peak mode of stage 15 and its output meter
+    bool clipperTruePeak = false;
+    TruePeakLimiter truePeakLimiter;
+    TruePeakInterpolator truePeakMeter;
+    static constexpr double truePeakReleaseSeconds = 0.5;
+    float truePeakHold = 0.0f;
+    std::atomic<float> truePeakLevel { 0.0f };
+    
+    StageProfiler profiler;
     
     // Parameters
     float attackAmount = 0.0f;
@@ -578,6 +1584,7 @@ private:
     float clipperCeiling = 0.8f; // Linear gain (0.0 to 1.0)
     float clipperDrive = 2.0f; // Drive intensity (1.0 to 10.0)
     ClipperType clipperType = ClipperType::QUINTIC; // Default: great for drums
+    ClipperAntialiasing clipperAntialiasing = ClipperAntialiasing::OFF; // Pointwise (aliasing) by default
     
     // Automatic Gain Compensation
     bool autoGainComp = true;
@@ -611,53 +1618,280 @@ private:
 
 
 
-    float processClipper(float input, float ceiling, float drive, ClipperType type) {
-        // PeakEater-style clipper: Drive is input gain, Ceiling is threshold
-        float drivenInput = input * drive; // Apply drive as input gain
-        float absInput = std::abs(drivenInput);
+    // Per-block counters shared by the processing and bypass paths
+    void advanceBlockPositions(int numSamples)
+    {
+        cachedEnvelopePosition += numSamples;
         
-        if (absInput <= ceiling) return drivenInput; // No clipping needed
+        if (lookaheadLength > 0)
+            lookaheadPosition = (lookaheadPosition + numSamples) % lookaheadLength;
+    }
+    
+    // Stage 15 over one (possibly oversampled) chunk: pointwise curves use the
+    // curve-specialised kernels, ADAA keeps per-channel history
+    template<typename Block>
+    void processClipperBlock(Block& block, ClipperAntialiasing antialiasing)
+    {
+        if (! clipperEnabled)
+            return;
         
-        float sign = (drivenInput >= 0.0f) ? 1.0f : -1.0f;
-        float normalizedInput = absInput / ceiling; // Normalize to ceiling for clipping algorithms
-        float clippedValue = 0.0f;
+        const int numBlockSamples = static_cast<int>(block.getNumSamples());
         
-        switch (type) {
-            case ClipperType::HARD:
-                clippedValue = 1.0f; // Hard clip at ceiling
-                break;
-                
-            case ClipperType::QUINTIC: // Great for drums - smooth but punchy
-                clippedValue = normalizedInput - (1.0f/5.0f) * std::pow(normalizedInput, 5.0f);
-                clippedValue = std::min(1.0f, clippedValue);
-                break;
-                
-            case ClipperType::CUBIC: // Warm saturation for cymbals
-                clippedValue = normalizedInput - (1.0f/3.0f) * std::pow(normalizedInput, 3.0f);
-                clippedValue = std::min(1.0f, clippedValue);
-                break;
-                
-            case ClipperType::TANGENT: // Musical saturation
-                clippedValue = std::tanh(normalizedInput * 0.7f) / std::tanh(0.7f);
-                break;
+        for (int ch = 0; ch < static_cast<int>(block.getNumChannels()); ++ch) {
+            auto* data = block.getChannelPointer(static_cast<size_t>(ch));
+            
+            if (antialiasing == ClipperAntialiasing::OFF) {
+                ClipperKernels::process(clipperType, data, numBlockSamples, clipperCeiling, clipperDrive);
+            } else {
+                for (int i = 0; i < numBlockSamples; ++i)
+                    data[i] = channels[ch].adaaClipper.process(data[i], clipperCeiling, clipperDrive, clipperType, antialiasing);
+            }
+        }
+    }
+
+    // tanh, exact or Pade (FAST_MATH quality tier and up). The Pade form is only
+    // valid on [-5, 5]; tanh is within 1e-4 of +-1 beyond that.
+    static float saturate(float x, bool exactMath) {
+        return exactMath ? std::tanh(x)
+                         : juce::dsp::FastMathApproximations::tanh(juce::jlimit(-5.0f, 5.0f, x));
+    }
+
+    // Stages 12-14 for one sample: tape clipper, dry/wet mix with its safety limit,
+    // auto gain compensation
+    float processOutputStages(float inputSample, float processedSample, bool exactMath, StageProfiler::Laps& laps)
+    {
+        // 12. Apply Tape Clipper (DrumSnapper-inspired)
+        if (tapeClip) {
+            processedSample = processTapeClipper(processedSample, exactMath);
+        }
+        
+        laps.mark(ProfilerStage::TAPE_CLIP);
+        
+        // 13. Apply mix control with safety limiting
+        float mixedSample = inputSample * (1.0f - mix) + processedSample * mix;
+        
+        // 13.5. FINAL SAFETY LIMITING - prevent clipping
+        mixedSample = std::max(-2.0f, std::min(2.0f, mixedSample)); // Hard limit to prevent extreme values
+        
+        // 14. Automatic Gain Compensation (Pirkle style)
+        if (autoGainComp) {
+            // Calculate input and output RMS for gain compensation
+            inputRMS = rmsCoeff * inputRMS + (1.0f - rmsCoeff) * (inputSample * inputSample);
+            float tempOutputRMS = rmsCoeff * outputRMS + (1.0f - rmsCoeff) * (mixedSample * mixedSample);
+            outputRMS = tempOutputRMS;
+            
+            // Calculate makeup gain to match input level
+            float makeupGain = 1.0f;
+            if (outputRMS > 1e-10f && inputRMS > 1e-10f) {
+                makeupGain = std::sqrt(inputRMS / outputRMS);
+                makeupGain = std::max(0.1f, std::min(3.0f, makeupGain)); // Limit makeup gain
+            }
+            
+            mixedSample *= makeupGain;
+        }
+        
+        laps.mark(ProfilerStage::AUTO_GAIN);
+        return mixedSample;
+    }
+
+    // Stage 15 latency pad: delays the chunk by latencyPadLength in place, or with
+    // delayAudio false only records its tail, keeping the ring current while the
+    // oversampler supplies the delay
+    template<typename Block>
+    void processLatencyPad(Block& block, bool delayAudio)
+    {
+        if (latencyPadLength == 0)
+            return;
+        
+        const int numBlockSamples = static_cast<int>(block.getNumSamples());
+        const int first = delayAudio ? 0 : std::max(0, numBlockSamples - latencyPadLength);
+        
+        for (int ch = 0; ch < numChannels; ++ch) {
+            auto* data = block.getChannelPointer(static_cast<size_t>(ch));
+            float* line = latencyPadBuffer + ch * latencyPadLength;
+            int position = (latencyPadPosition + first) % latencyPadLength;
+            
+            for (int i = first; i < numBlockSamples; ++i) {
+                const float delayed = line[position];
+                line[position] = data[i];
                 
-            case ClipperType::ALGEBRAIC: // Smooth limiting
-                clippedValue = normalizedInput / std::sqrt(1.0f + normalizedInput * normalizedInput);
-                break;
+                if (delayAudio)
+                    data[i] = delayed;
                 
-            case ClipperType::ARCTANGENT: // Subtle enhancement
-                clippedValue = (2.0f / M_PI) * std::atan(normalizedInput * M_PI * 0.5f);
-                break;
+                if (++position == latencyPadLength)
+                    position = 0;
+            }
         }
         
-        // Return clipped output at ceiling level (PeakEater style)
-        return sign * clippedValue * ceiling;
+        latencyPadPosition = (latencyPadPosition + numBlockSamples) % latencyPadLength;
     }
-    
+
     // Tape Clipper from DrumSnapper
-    float processTapeClipper(float sample) {
+    float processTapeClipper(float sample, bool exactMath) {
         float x = sample;
-        float s = juce::jlimit<float>(-0.95f, 0.95f, tanhf(powf(x, 5) + x) * 0.95f);
+        float s = juce::jlimit<float>(-0.95f, 0.95f, saturate(x * x * x * x * x + x, exactMath) * 0.95f);
         return s;
     }
-}; 
\ No newline at end of file
+};
+
+//==============================================================================
+/**
+*/
+class AtakAtakAudioProcessor  : public juce::AudioProcessor,
+                                private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    AtakAtakAudioProcessor();
+    ~AtakAtakAudioProcessor() override;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+
+   #ifndef JucePlugin_PreferredChannelConfigurations
+    bool isBusesLayoutSupported (const BusesLayout& buses) const override;
+   #endif
+
+    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+
+    // Host-visible bypass: processBlock handles it (with a crossfade) so hosts
+    // can bypass natively instead of skipping the plugin
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+
+// Per-stage TransientDesigner timing for the editor/telemetry (lock-free reads;
+    // only populated when built with ATAKATAK_STAGE_PROFILER)
+    const StageProfiler& getStageProfiler() const;
+
+    // Offline analysis: read the transient detector from a precomputed cache instead
+    // of running it (nullptr = live detection). Renders then start at the cache's first
+    // sample; set it after prepareToPlay. Not for realtime use.
+    void setCachedDetectorEnvelope (const DetectorEnvelopeCache* cache);
+
+    // Adaptive quality: current realtime tier and peak processBlock load (fraction of
+    // the block deadline). Lock-free, for the UI and telemetry.
+    QualityTier getQualityTier() const      { return qualityController.getPublishedTier(); }
+    float getProcessingLoad() const         { return qualityController.getPublishedLoad(); }
+
+    // Output true-peak meter (linear, peak hold with 0.5 s release) while the clipper's
+    // true-peak mode is on; lock-free
+    float getTruePeakLevel() const          { return transientDesigner.getTruePeakLevel(); }
+
+    // Bytes of DSP state this instance owns after prepareToPlay (processor object,
+    // TransientDesigner arena and buffers, bypass dry path)
+    size_t getMemoryFootprint() const;
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override;
+
+    //==============================================================================
+    const juce::String getName() const override;
+
+    bool acceptsMidi() const override;
+    bool producesMidi() const override;
+    bool isMidiEffect() const override;
+    double getTailLengthSeconds() const override;
+
+    //==============================================================================
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram (int index) override;
+    const juce::String getProgramName (int index) override;
+    void changeProgramName (int index, const juce::String& newName) override;
+
+    // Programs 0..n-1 are the factory presets; unlike getNumPrograms this does not
+    // start the user preset scan
+    int getNumFactoryPrograms() const;
+
+    //==============================================================================
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+
+    //==============================================================================
+    // Parameter access
+    juce::AudioProcessorValueTreeState& getAPVTS() { return parameters; }
+    
+    //==============================================================================
+    // Parameter layout
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
+private:
+    //==============================================================================
+    void updateParameters();
+    void resetAllParametersToDefaults();
+
+    // Compact binary state chunk: magic, version, count, then count plain values.
+    // Legacy XML chunks (copyXmlToBinary) are still accepted by readStateSnapshot.
+    static constexpr int stateMagic = 0x536b7441; // "AtkS" little-endian
+    static constexpr int stateVersion = 1;
+    static constexpr int stateHeaderSize = 3 * static_cast<int> (sizeof (juce::int32));
+
+    bool readStateSnapshot (const void* data, int sizeInBytes, ParameterSnapshot& snapshot) const;
+    void applySnapshot (const ParameterSnapshot& snapshot, bool includeBypass = true);
+    ParameterSnapshot getDefaultSnapshot() const;
+
+    // Programs: setCurrentProgram publishes the preset snapshot, the audio thread
+    // swaps it in at the start of the next block and the host is told afterwards.
+    void applyPendingProgram();
+    void handleAsyncUpdate() override;
+
+
+    // Replaces NaN / inf input samples with silence before anything reads them
+    void sanitiseInput (juce::AudioBuffer<float>& buffer);
+
+    // Bypass: latency-aligned dry signal and a short preallocated crossfade
+    void prepareDryPath (const juce::dsp::ProcessSpec& spec);
+    void fillDryBuffer (const juce::AudioBuffer<float>& buffer);
+    void renderBypassed (juce::AudioBuffer<float>& buffer);
+    void applyBypassCrossfade (juce::AudioBuffer<float>& buffer);
+
+    // Swaps the TransientDesigner quality profile / detector engine / true-peak mode
+    // on the audio thread (no allocation); all of them can change the latency
+    void applyRenderQuality (bool offline);
+    void applyDetectorEngine (DetectorEngine engine);
+    void applyTruePeakMode (bool enabled);
+    void latencyChangedOnAudioThread();
+
+    // Latency to report from the message thread (handleAsyncUpdate), -1 = none pending
+    std::atomic<int> pendingLatencySamples { -1 };
+
+    juce::AudioBuffer<float> dryBuffer;
+    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> dryDelay;
+    int dryDelaySamples = 0;
+    bool bypassTarget = false;
+    int bypassFadeLength = 1;
+    int bypassFadeRemaining = 0;
+
+    // Steps the realtime quality down under CPU pressure (see QualityController.h)
+    AdaptiveQualityController qualityController;
+    bool adaptiveQualityActive = false;
+
+    // Last prepared layout, for incremental prepareToPlay
+    double preparedSampleRate = 0.0;
+    juce::uint32 preparedNumChannels = 0;
+
+    // DSP processors, held inline so an instance's state is one allocation plus
+    // the TransientDesigner arena. The gain processors stay out of the arena: their
+    // smoother only runs in fillGainRamp, once per chunk, into the arena scratch.
+GainProcessor inputGainProcessor;
+    GainProcessor outputGainProcessor;
+    TransientDesigner transientDesigner;
+    
+    // Parameter tree
+    juce::AudioProcessorValueTreeState parameters;
+
+    // Cached in stateParameterIDs order so state save/load never looks up IDs
+    std::array<juce::RangedAudioParameter*, numStateParameters> stateParameters {};
+    std::array<std::atomic<float>*, numStateParameters> stateValues {};
+
+    // Factory + user presets
+    std::unique_ptr<PresetBank> presetBank;
+    std::atomic<int> currentProgram { 0 };
+    std::atomic<const ParameterSnapshot*> pendingProgram { nullptr };
+    std::atomic<bool> programNeedsHostSync { false };
+    std::atomic<bool> programListChanged { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AtakAtakAudioProcessor)
+};
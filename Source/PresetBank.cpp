@@ -0,0 +1,141 @@
+#include "PresetBank.h"
+
+namespace
+{
+    struct PresetValue
+    {
+        const char* id;
+        float value;
+    };
+
+    struct FactoryPreset
+    {
+        const char* name;
+        std::vector<PresetValue> values; // Overrides on top of the defaults
+    };
+
+    // Drum-oriented starting points. Parameters not listed keep their defaults.
+    const FactoryPreset factoryPresetTable[] = {
+        { "Init", {} },
+        { "Punchy Kick", { { "attackAmount", 60.0f }, { "sustainAmount", -20.0f },
+                           { "snapAmount", 40.0f }, { "clipperEnabled", 1.0f },
+                           { "clipperType", 1.0f }, { "clipperDrive", 1.5f } } },
+        { "Tight Snare", { { "attackAmount", 50.0f }, { "sustainAmount", -50.0f },
+                           { "snapAmount", 80.0f }, { "snapHardness", 3.0f },
+                           { "harmonicEnhancement", 20.0f } } },
+        { "Room Snare", { { "attackAmount", 20.0f }, { "sustainAmount", 60.0f },
+                          { "releaseTime", 250.0f }, { "temporalWeight", 1.4f } } },
+        { "Snappy Toms", { { "attackAmount", 40.0f }, { "sustainAmount", 20.0f },
+                           { "snapAmount", 30.0f }, { "focus", 1.5f } } },
+        { "Crisp Hats", { { "attackAmount", 30.0f }, { "sustainAmount", -40.0f },
+                          { "hfGain", 3.0f }, { "hfSaturation", 30.0f } } },
+        { "Drum Bus Glue", { { "attackAmount", 15.0f }, { "sustainAmount", 10.0f },
+                             { "tapeClip", 1.0f }, { "clipperEnabled", 1.0f },
+                             { "clipperType", 3.0f }, { "clipperCeiling", 0.9f },
+                             { "clipperDrive", 1.5f }, { "mix", 70.0f } } },
+        { "Soft Overheads", { { "attackAmount", -40.0f }, { "sustainAmount", 20.0f },
+                              { "mix", 80.0f } } }
+    };
+}
+
+//==============================================================================
+class PresetBank::ScanThread  : public juce::Thread
+{
+public:
+    explicit ScanThread (PresetBank& b) : juce::Thread ("AtakAtak Preset Scan"), bank (b) {}
+
+    void run() override { bank.scanUserPresets (*this); }
+
+private:
+    PresetBank& bank;
+};
+
+//==============================================================================
+PresetBank::PresetBank (const ParameterSnapshot& defaults, StateDecoder decoder)
+    : decodeState (std::move (decoder))
+{
+    // Precompute every factory snapshot up front
+    for (auto& factory : factoryPresetTable)
+    {
+        Preset preset { factory.name, defaults };
+
+        for (auto& value : factory.values)
+        {
+            const int index = getStateParameterIndex (value.id);
+            jassert (index >= 0);
+
+            if (index >= 0)
+                preset.values[(size_t) index] = value.value;
+        }
+
+        factoryPresets.push_back (std::move (preset));
+    }
+}
+
+PresetBank::~PresetBank()
+{
+    if (scanThread != nullptr)
+        scanThread->stopThread (2000);
+}
+
+int PresetBank::getNumPresets()
+{
+    if (! scanStarted.exchange (true))
+    {
+        scanThread = std::make_unique<ScanThread> (*this);
+        scanThread->startThread (juce::Thread::Priority::low);
+    }
+
+    return (int) factoryPresets.size() + numUserPresets.load (std::memory_order_acquire);
+}
+
+const PresetBank::Preset* PresetBank::getPreset (int index) const
+{
+    const int numFactory = (int) factoryPresets.size();
+
+    if (juce::isPositiveAndBelow (index, numFactory))
+        return &factoryPresets[(size_t) index];
+
+    if (juce::isPositiveAndBelow (index - numFactory, numUserPresets.load (std::memory_order_acquire)))
+        return &userPresets[(size_t) (index - numFactory)];
+
+    return nullptr;
+}
+
+juce::File PresetBank::getUserPresetDirectory()
+{
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+               .getChildFile ("AtakAtak")
+               .getChildFile ("Presets");
+}
+
+void PresetBank::scanUserPresets (juce::Thread& thread)
+{
+    auto files = getUserPresetDirectory().findChildFiles (juce::File::findFiles, false, userPresetWildcard);
+
+    std::sort (files.begin(), files.end(), [] (const juce::File& a, const juce::File& b)
+    {
+        return a.getFileName().compareNatural (b.getFileName()) < 0;
+    });
+
+    for (auto& file : files)
+    {
+        if (thread.threadShouldExit())
+            return;
+
+        juce::MemoryBlock chunk;
+        Preset preset { file.getFileNameWithoutExtension(), {} };
+
+        if (file.loadFileAsData (chunk) && decodeState (chunk, preset.values))
+            userPresets.push_back (std::move (preset));
+    }
+
+    if (userPresets.empty())
+        return;
+
+    // Publish: readers only touch indices below numUserPresets
+    numUserPresets.store ((int) userPresets.size(), std::memory_order_release);
+
+    if (onUserPresetsLoaded != nullptr)
+        onUserPresetsLoaded();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "PluginProcessor.h"
+#include <functional>
+
+//==============================================================================
+// Factory presets plus user presets from disk, all held as precomputed
+// ParameterSnapshots so a program change is just a pointer swap.
+// Program indices: factory presets first, then user presets (sorted by name).
+class PresetBank
+{
+public:
+    struct Preset
+    {
+        juce::String name;
+        ParameterSnapshot values;
+    };
+
+    // Decodes a state chunk (binary or legacy XML) into a snapshot
+    using StateDecoder = std::function<bool (const juce::MemoryBlock&, ParameterSnapshot&)>;
+
+    PresetBank (const ParameterSnapshot& defaults, StateDecoder decoder);
+    ~PresetBank();
+
+    // Starts the background user preset scan on first call
+    int getNumPresets();
+
+    // Indices 0..n-1; no scan
+    int getNumFactoryPresets() const { return (int) factoryPresets.size(); }
+
+    // nullptr for out-of-range indices (or user presets not scanned yet)
+    const Preset* getPreset (int index) const;
+
+    // Called on the scan thread once the user presets have been published
+    std::function<void()> onUserPresetsLoaded;
+
+    // User presets are saved state chunks: <user app data>/AtakAtak/Presets/*.atakpreset
+    static juce::File getUserPresetDirectory();
+    static constexpr const char* userPresetWildcard = "*.atakpreset";
+
+private:
+    class ScanThread;
+
+    void scanUserPresets (juce::Thread& thread);
+
+    std::vector<Preset> factoryPresets;
+
+    // Written only by the scan thread before numUserPresets is published
+    std::vector<Preset> userPresets;
+    std::atomic<int> numUserPresets { 0 };
+
+    StateDecoder decodeState;
+    std::unique_ptr<ScanThread> scanThread;
+    std::atomic<bool> scanStarted { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+};
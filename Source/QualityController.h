@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+//==============================================================================
+// Realtime quality tiers, cheapest last. Each tier keeps the savings of the ones
+// before it. Offline renders always run at FULL.
+enum class QualityTier
+{
+    FULL = 0,              // As configured
+    REDUCED_ANTIALIASING,  // Clipper ADAA capped at 1st order
+    FAST_MATH,             // Pointwise SIMD clipper kernels, Pade tanh everywhere
+    CONTROL_RATE,          // Eco detection: slow envelopes at a decimated control rate (Envelope engine only)
+    LINKED_DETECTION,      // One detector on the channel peak, shared by all channels (Envelope engine only)
+    NUM_TIERS
+};
+
+inline constexpr int numQualityTiers = static_cast<int> (QualityTier::NUM_TIERS);
+
+//==============================================================================
+// Processing-budget monitor: compares each processBlock's time with its deadline
+// (block size / sample rate), steps down one tier as soon as a block overruns the
+// step-down load and only steps back up after the peak load has stayed under the
+// step-up load for a while. Audio thread writes; the tier and load are published
+// through atomics for the UI and telemetry.
+class AdaptiveQualityController
+{
+public:
+    // Fractions of the block deadline
+    static constexpr double stepDownLoad = 0.5;
+    static constexpr double stepUpLoad = 0.2;
+
+    static constexpr double peakDecaySeconds = 0.5;  // Peak-hold release of the measured load
+    static constexpr double stepUpHoldSeconds = 2.0; // Headroom needed before stepping up
+    static constexpr double cooldownSeconds = 0.1;   // Let a new tier settle before the next step
+
+    void prepare (double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+
+    void reset()
+    {
+        tier = QualityTier::FULL;
+        peakLoad = 0.0;
+        headroomTime = 0.0;
+        cooldownTime = 0.0;
+        publish();
+    }
+
+    // Audio thread: the tier for the next block
+    QualityTier getTier() const { return tier; }
+
+    // Any thread
+    QualityTier getPublishedTier() const { return static_cast<QualityTier> (publishedTier.load (std::memory_order_relaxed)); }
+    float getPublishedLoad() const       { return publishedLoad.load (std::memory_order_relaxed); }
+
+    // Audio thread, after each processed block
+    void update (double blockSeconds, int numSamples)
+    {
+        if (numSamples <= 0 || sampleRate <= 0.0)
+            return;
+
+        const double deadline = numSamples / sampleRate;
+        const double load = blockSeconds / deadline;
+
+        peakLoad = std::max (load, peakLoad * std::exp (-deadline / peakDecaySeconds));
+        cooldownTime = std::max (0.0, cooldownTime - deadline);
+
+        const int index = static_cast<int> (tier);
+
+        if (load > stepDownLoad)
+        {
+            headroomTime = 0.0;
+
+            if (cooldownTime <= 0.0 && index < numQualityTiers - 1)
+            {
+                tier = static_cast<QualityTier> (index + 1);
+                cooldownTime = cooldownSeconds;
+            }
+        }
+        else if (peakLoad < stepUpLoad && index > 0)
+        {
+            headroomTime += deadline;
+
+            if (headroomTime >= stepUpHoldSeconds && cooldownTime <= 0.0)
+            {
+                tier = static_cast<QualityTier> (index - 1);
+                headroomTime = 0.0;
+                cooldownTime = cooldownSeconds;
+            }
+        }
+        else
+        {
+            headroomTime = 0.0;
+        }
+
+        publish();
+    }
+
+private:
+    void publish()
+    {
+        publishedTier.store (static_cast<int> (tier), std::memory_order_relaxed);
+        publishedLoad.store (static_cast<float> (peakLoad), std::memory_order_relaxed);
+    }
+
+    double sampleRate = 44100.0;
+    QualityTier tier = QualityTier::FULL;
+    double peakLoad = 0.0;
+    double headroomTime = 0.0;
+    double cooldownTime = 0.0;
+
+    std::atomic<int> publishedTier { 0 };
+    std::atomic<float> publishedLoad { 0.0f };
+};
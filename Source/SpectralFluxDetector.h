@@ -0,0 +1,193 @@
+#pragma once
+
+#include "../JUCE/modules/juce_dsp/juce_dsp.h"
+#include "StateArena.h"
+#include <cmath>
+#include <vector>
+
+//==============================================================================
+// Transient detection engines
+enum class DetectorEngine
+{
+    ENVELOPE = 0,   // DualEnvelopeDetector: broadband fast - slow envelope
+    SPECTRAL_FLUX   // SpectralFluxDetector: per-bin magnitude increase over a short STFT
+};
+
+//==============================================================================
+// Spectral-flux onset detector. Every hop, the last fftSize samples are Hann
+// windowed and transformed; the flux is the L2 norm of the per-bin magnitude
+// increases over the largest magnitude of the last referenceFrames frames
+// (decreases are ignored). A bass note's period is longer than the ~5 ms window,
+// so its low bins ripple with the waveform from frame to frame; against the
+// ~10 ms maximum that ripple, and with it a steady kick decay, contributes
+// nothing while a hi-hat on top of it still shows up in its own bins.
+//
+// The flux is scaled by the window gain so it tracks signal amplitude (a sine
+// appearing at amplitude A peaks at about 0.65 A), putting it in the same range
+// as the envelope detector's output. Values come at hop rate and are linearly
+// interpolated to audio rate; that and the window centre make the output lag
+// the audio by getLookaheadSamples(), which the caller compensates by delaying
+// the audio path.
+//
+// One FFT plan and one scratch frame are shared by all channels; per-channel
+// history is carved from the owner's StateArena in prepare() (getStateBytes()
+// tells the owner how much to reserve).
+class SpectralFluxDetector
+{
+public:
+    // Budget the detector benchmark checks: fraction of one core per channel in realtime
+    static constexpr double cpuBudgetPerChannel = 0.01;
+
+    // Frames each bin is compared against (8 hops: ~10 ms at every sample rate)
+    static constexpr int referenceFrames = 8;
+
+    // ~5 ms window at any rate, 75% overlap
+    static int getFftOrder(double sampleRate)
+    {
+        return 8 + (sampleRate > 50000.0 ? 1 : 0) + (sampleRate > 100000.0 ? 1 : 0);
+    }
+
+    static int getLookaheadSamples(double sampleRate)
+    {
+        const int size = 1 << getFftOrder(sampleRate);
+        return size / 2 + size / 4;
+    }
+
+    // Arena bytes prepare() carves: the channel states, then each channel's history and recent frames
+    static std::size_t getStateBytes(double sampleRate, int numChannels)
+    {
+        const int size = 1 << getFftOrder(sampleRate);
+        const auto channelCount = static_cast<std::size_t>(numChannels);
+
+        return StateArena::bytesFor<ChannelState>(channelCount)
+             + channelCount * (StateArena::bytesFor<float>(static_cast<std::size_t>(size))
+                               + StateArena::bytesFor<float>(static_cast<std::size_t>((size / 2 + 1) * referenceFrames)));
+    }
+
+    void prepare(double sampleRate, int newNumChannels, StateArena& arena)
+    {
+        const int order = getFftOrder(sampleRate);
+
+        if (fft == nullptr || fft->getSize() != (1 << order))
+            fft = std::make_unique<juce::dsp::FFT>(order);
+
+        fftSize = 1 << order;
+        hopSize = fftSize / 4;
+        invHopSize = 1.0f / static_cast<float>(hopSize);
+        numBins = fftSize / 2 + 1;
+
+        window.resize(static_cast<size_t>(fftSize));
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), static_cast<size_t>(fftSize),
+                                                                juce::dsp::WindowingFunction<float>::hann, false);
+
+        float windowSum = 0.0f;
+        for (auto w : window)
+            windowSum += w;
+        fluxScale = 2.0f / windowSum;
+
+        frame.assign(static_cast<size_t>(2 * fftSize), 0.0f);
+
+        // Zeroed by the arena; every region on its own cache line
+        numChannels = newNumChannels;
+        channels = arena.create<ChannelState>(static_cast<size_t>(numChannels));
+
+        for (int ch = 0; ch < numChannels; ++ch) {
+            channels[ch].history = arena.create<float>(static_cast<size_t>(fftSize));
+            channels[ch].recentMagnitudes = arena.create<float>(static_cast<size_t>(numBins * referenceFrames));
+        }
+    }
+
+    void reset()
+    {
+        for (int ch = 0; ch < numChannels; ++ch) {
+            auto& state = channels[ch];
+            std::fill_n(state.history, fftSize, 0.0f);
+            std::fill_n(state.recentMagnitudes, numBins * referenceFrames, 0.0f);
+            state.writePosition = 0;
+            state.recentPosition = 0;
+            state.hopCounter = 0;
+            state.previousFlux = state.currentFlux = 0.0f;
+        }
+    }
+
+    // Detection lags the input by half a window (frame centre) plus one hop (interpolation)
+    int getLookaheadSamples() const { return fftSize / 2 + hopSize; }
+
+    // Heap bytes held by the window and scratch frame (the channel state is in the arena)
+    size_t getMemoryFootprint() const
+    {
+        return (window.capacity() + frame.capacity()) * sizeof(float);
+    }
+
+    float process(int channel, float input)
+    {
+        auto& state = channels[channel];
+
+        state.history[static_cast<size_t>(state.writePosition)] = input;
+        state.writePosition = (state.writePosition + 1) & (fftSize - 1);
+
+        if (++state.hopCounter >= hopSize) {
+            state.hopCounter = 0;
+            state.previousFlux = state.currentFlux;
+            state.currentFlux = analyseFrame(state);
+        }
+
+        return state.previousFlux + (state.currentFlux - state.previousFlux) * (static_cast<float>(state.hopCounter) * invHopSize);
+    }
+
+private:
+    struct ChannelState
+    {
+        float* history = nullptr;              // Ring of the last fftSize samples
+        float* recentMagnitudes = nullptr;     // Last referenceFrames frames, referenceFrames per bin
+        int writePosition = 0;
+        int recentPosition = 0;                // Oldest frame in recentMagnitudes
+        int hopCounter = 0;
+        float previousFlux = 0.0f, currentFlux = 0.0f;
+    };
+
+    float analyseFrame(ChannelState& state)
+    {
+        // Oldest sample first (writePosition points at it)
+        const int head = fftSize - state.writePosition;
+        juce::FloatVectorOperations::multiply(frame.data(), state.history + state.writePosition, window.data(), head);
+        juce::FloatVectorOperations::multiply(frame.data() + head, state.history, window.data() + head, state.writePosition);
+        std::fill(frame.begin() + fftSize, frame.end(), 0.0f);
+
+        fft->performFrequencyOnlyForwardTransform(frame.data(), true);
+
+        float sum = 0.0f;
+
+        for (int bin = 0; bin < numBins; ++bin) {
+            const float magnitude = frame[static_cast<size_t>(bin)];
+            float* recent = state.recentMagnitudes + bin * referenceFrames;
+            float reference = recent[0];
+
+            for (int f = 1; f < referenceFrames; ++f)
+                reference = std::max(reference, recent[f]);
+
+            const float increase = magnitude - reference;
+
+            if (increase > 0.0f)
+                sum += increase * increase;
+
+            recent[state.recentPosition] = magnitude;
+        }
+
+        state.recentPosition = (state.recentPosition + 1) % referenceFrames;
+
+        return std::sqrt(sum) * fluxScale;
+    }
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> window;
+    std::vector<float> frame; // 2 * fftSize scratch for the real-only transform
+    ChannelState* channels = nullptr; // In the owner's arena
+    int numChannels = 0;
+
+    int fftSize = 256;
+    int hopSize = 64;
+    int numBins = 129;
+    float invHopSize = 1.0f / 64.0f;
+    float fluxScale = 1.0f;
+};
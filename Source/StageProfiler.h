@@ -0,0 +1,269 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined (__x86_64__) || defined (_M_X64) || defined (__i386__) || defined (_M_IX86)
+ #define ATAKATAK_PROFILER_USE_RDTSC 1
+ #if defined (_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#else
+ #define ATAKATAK_PROFILER_USE_RDTSC 0
+#endif
+
+// Per-stage cycle profiler for TransientDesigner. Off by default: configure with
+// -DATAKATAK_STAGE_PROFILER=ON (or define ATAKATAK_STAGE_PROFILER=1) to enable it.
+// When disabled every call below is an empty inline and compiles to nothing.
+//
+// The per-sample stages cost a few ns each, close to one timer read, so timing
+// every sample would mostly measure the timer. Each channel's per-sample loop is
+// timed whole per chunk instead and split across its stages in the proportions of
+// every sampleStride-th sample, less the timer's own cost (calibrated at
+// construction); the per-chunk stages are timed whole. The split is an estimate
+// for comparing stages, and a profiler build is not representative of a release
+// build: measure absolute CPU with the profiler off (Benchmarks/).
+#ifndef ATAKATAK_STAGE_PROFILER
+ #define ATAKATAK_STAGE_PROFILER 0
+#endif
+
+//==============================================================================
+// Stages in TransientDesigner::process order (the numbers are its stage comments)
+enum class ProfilerStage
+{
+    DETECTION = 0,  // 1.  dual envelope + attack/sustain followers
+    GAINS,          // 4-5. gain computation and psychoacoustic weighting
+    SNAP,           // 6.  SNAP waveshaper
+    HARMONICS,      // 7-8.5 harmonic enhancement, focus, safety limits
+    SHAPING,        // 9-11 attack/sustain components and transient mix
+    HF_SATURATION,  // 11. HF saturation
+    TAPE_CLIP,      // 12. tape clipper
+    AUTO_GAIN,      // 13-14 dry/wet mix and auto gain compensation
+    CLIPPER,        // 15. final clipper (incl. oversampling) and output gain
+    NUM_STAGES
+};
+
+inline constexpr int numProfilerStages = static_cast<int> (ProfilerStage::NUM_STAGES);
+
+inline const char* getProfilerStageName (ProfilerStage stage)
+{
+    constexpr const char* names[] = { "Detection", "Gains", "Snap", "Harmonics", "Shaping",
+                                      "HF Saturation", "Tape Clip", "Auto Gain", "Clipper" };
+    return names[static_cast<int> (stage)];
+}
+
+#if ATAKATAK_STAGE_PROFILER
+
+//==============================================================================
+// Written by the audio thread once per block; readable lock-free from any thread.
+// Counters only grow - readers diff two reads to get a rate.
+class StageProfiler
+{
+public:
+    static constexpr bool enabled = true;
+
+    using Ticks = std::uint64_t;
+
+    // TSC cycles on x86, steady_clock nanoseconds elsewhere
+    static Ticks now() noexcept
+    {
+       #if ATAKATAK_PROFILER_USE_RDTSC
+        return static_cast<Ticks> (__rdtsc());
+       #else
+        return static_cast<Ticks> (std::chrono::duration_cast<std::chrono::nanoseconds> (
+                                       std::chrono::steady_clock::now().time_since_epoch()).count());
+       #endif
+    }
+
+    static constexpr const char* getTickUnit() { return ATAKATAK_PROFILER_USE_RDTSC ? "cycles" : "ns"; }
+
+    // The per-sample stages are split in the proportions of one sample in this many
+    // (odd, so the timed samples do not line up with power-of-two blocks and chunks)
+    static constexpr int sampleStride = 61;
+
+    StageProfiler() noexcept : timerOverhead (measureTimerOverhead()) {}
+
+    // Audio-thread accumulator for one block: mark() charges the time since the
+    // previous start/mark to a stage, so the hot loop never touches an atomic.
+    // Between startSamples() and endSamples() (one channel's per-sample loop over a
+    // chunk) the loop is timed whole, and only every sampleStride-th sample's marks
+    // read the timer, to get the stage proportions.
+    class Laps
+    {
+    public:
+        explicit Laps (const StageProfiler& profiler) noexcept
+            : blockStart (now()), last (blockStart),
+              overhead (profiler.timerOverhead), samplesUntilTimed (profiler.samplesUntilTimed) {}
+
+        // Per-chunk stage: always timed
+        void start() noexcept
+        {
+            timing = true;
+            last = now();
+        }
+
+        void startSamples() noexcept
+        {
+            inSamples = true;
+            loopReads = 0;
+            loopStart = now();
+        }
+
+        void startSample() noexcept
+        {
+            timing = --samplesUntilTimed <= 0;
+
+            if (timing) {
+                samplesUntilTimed = sampleStride;
+                ++loopReads;
+                last = now();
+            }
+        }
+
+        // The loop's time less the sampled reads
+        void endSamples() noexcept
+        {
+            const auto elapsed = now() - loopStart;
+            const auto timer = (loopReads + 1) * overhead;
+            loopTicks += elapsed > timer ? elapsed - timer : 0;
+            inSamples = false;
+        }
+
+        void mark (ProfilerStage stage) noexcept
+        {
+            if (! timing)
+                return;
+
+            const auto t = now();
+            const auto lap = t - last > overhead ? t - last - overhead : 0;
+            last = t;
+
+            if (inSamples) {
+                sampledTicks[static_cast<size_t> (stage)] += lap;
+                ++loopReads;
+            } else {
+                ticks[static_cast<size_t> (stage)] += lap;
+            }
+        }
+
+    private:
+        friend class StageProfiler;
+
+        Ticks blockStart, last, overhead;
+        Ticks loopStart = 0, loopReads = 0, loopTicks = 0;
+        int samplesUntilTimed;
+        bool timing = true, inSamples = false;
+        std::array<Ticks, numProfilerStages> ticks {}, sampledTicks {};
+    };
+
+    // Audio thread, end of block (single writer: plain load + store, no RMW). The
+    // per-sample loop time goes to its stages in the proportions sampled so far.
+    void publish (const Laps& laps) noexcept
+    {
+        samplesUntilTimed = laps.samplesUntilTimed;
+
+        for (size_t i = 0; i < sampledTotals.size(); ++i) {
+            sampledTotals[i] += laps.sampledTicks[i];
+            sampledSum += laps.sampledTicks[i];
+        }
+
+        for (size_t i = 0; i < stageTicks.size(); ++i) {
+            const auto share = sampledSum > 0 ? static_cast<double> (sampledTotals[i]) / static_cast<double> (sampledSum) : 0.0;
+            const auto loopShare = static_cast<Ticks> (static_cast<double> (laps.loopTicks) * share);
+            stageTicks[i].store (stageTicks[i].load (std::memory_order_relaxed) + laps.ticks[i] + loopShare, std::memory_order_relaxed);
+        }
+
+        const auto blockTicks = now() - laps.blockStart;
+        totalBlockTicks.store (totalBlockTicks.load (std::memory_order_relaxed) + blockTicks, std::memory_order_relaxed);
+
+        if (blockTicks > maxBlockTicks.load (std::memory_order_relaxed))
+            maxBlockTicks.store (blockTicks, std::memory_order_relaxed);
+
+        numBlocks.store (numBlocks.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    Ticks getStageTicks (ProfilerStage stage) const noexcept { return stageTicks[static_cast<size_t> (stage)].load (std::memory_order_relaxed); }
+    Ticks getTotalBlockTicks() const noexcept { return totalBlockTicks.load (std::memory_order_relaxed); }
+    Ticks getMaxBlockTicks() const noexcept   { return maxBlockTicks.load (std::memory_order_relaxed); }
+    std::uint64_t getNumBlocks() const noexcept { return numBlocks.load (std::memory_order_acquire); }
+
+    // Cost of one timer read, subtracted from every lap
+    Ticks getTimerOverhead() const noexcept { return timerOverhead; }
+
+private:
+    // Mean gap between back-to-back reads (a lap's floor), cheapest of a few runs
+    static Ticks measureTimerOverhead() noexcept
+    {
+        constexpr int readsPerRun = 256;
+        Ticks cheapest = ~Ticks();
+
+        for (int run = 0; run < 16; ++run)
+        {
+            const auto first = now();
+            auto t = first;
+
+            for (int i = 0; i < readsPerRun; ++i)
+                t = now();
+
+            const auto perRead = (t - first) / readsPerRun;
+            cheapest = perRead < cheapest ? perRead : cheapest;
+        }
+
+        return cheapest;
+    }
+
+    const Ticks timerOverhead;
+
+    // Audio thread only: stride phase carried across blocks, sampled stage totals
+    int samplesUntilTimed = sampleStride;
+    std::array<Ticks, numProfilerStages> sampledTotals {};
+    Ticks sampledSum = 0;
+
+    std::array<std::atomic<Ticks>, numProfilerStages> stageTicks {};
+    std::atomic<Ticks> totalBlockTicks { 0 };
+    std::atomic<Ticks> maxBlockTicks { 0 };
+    std::atomic<std::uint64_t> numBlocks { 0 };
+};
+
+#else
+
+//==============================================================================
+// Disabled build: same interface, no state, no code
+class StageProfiler
+{
+public:
+    static constexpr bool enabled = false;
+
+    using Ticks = std::uint64_t;
+
+    static constexpr Ticks now() noexcept { return 0; }
+    static constexpr const char* getTickUnit() { return ""; }
+
+    static constexpr int sampleStride = 1;
+
+    class Laps
+    {
+    public:
+        explicit Laps (const StageProfiler&) noexcept {}
+
+        void start() noexcept {}
+        void startSamples() noexcept {}
+        void startSample() noexcept {}
+        void endSamples() noexcept {}
+        void mark (ProfilerStage) noexcept {}
+    };
+
+    void publish (const Laps&) noexcept {}
+
+    Ticks getStageTicks (ProfilerStage) const noexcept { return 0; }
+    Ticks getTotalBlockTicks() const noexcept { return 0; }
+    Ticks getMaxBlockTicks() const noexcept { return 0; }
+    std::uint64_t getNumBlocks() const noexcept { return 0; }
+    Ticks getTimerOverhead() const noexcept { return 0; }
+};
+
+#endif
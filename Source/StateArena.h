@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+//==============================================================================
+// One cache-line-aligned block holding an instance's hot DSP state. Sized and
+// carved up in prepare (never on the audio thread); every region starts on its
+// own cache line, so state written per sample never shares a line with another
+// region or another instance.
+//
+// The owner sums bytesFor() over its regions, allocate()s once, then create()s
+// the regions in the same order.
+class StateArena
+{
+public:
+    static constexpr std::size_t cacheLineSize = 64;
+
+    static constexpr std::size_t roundUp(std::size_t bytes)
+    {
+        return (bytes + cacheLineSize - 1) & ~(cacheLineSize - 1);
+    }
+
+    template<typename T>
+    static constexpr std::size_t bytesFor(std::size_t count)
+    {
+        return roundUp(sizeof(T) * count);
+    }
+
+    // Discards the previous layout; only reallocates when the block has to grow
+    void allocate(std::size_t totalBytes)
+    {
+        totalBytes = roundUp(totalBytes);
+
+        if (totalBytes > capacity) {
+            storage.reset(static_cast<std::byte*>(::operator new[](totalBytes, std::align_val_t(cacheLineSize))));
+            capacity = totalBytes;
+        }
+
+        used = 0;
+    }
+
+    // Next region: count value-initialised Ts. Only trivially destructible state
+    // lives here, so the arena never runs destructors.
+    template<typename T>
+    T* create(std::size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "arena state must not need destruction");
+        static_assert(alignof(T) <= cacheLineSize, "over-aligned arena state");
+
+        auto* region = reinterpret_cast<T*>(storage.get() + used);
+        used += bytesFor<T>(count);
+        assert(used <= capacity);
+
+        std::uninitialized_value_construct_n(region, count);
+        return region;
+    }
+
+    std::size_t getSizeInBytes() const { return capacity; }
+
+private:
+    struct AlignedDelete
+    {
+        void operator()(std::byte* p) const { ::operator delete[](p, std::align_val_t(cacheLineSize)); }
+    };
+
+    std::unique_ptr<std::byte[], AlignedDelete> storage;
+    std::size_t capacity = 0;
+    std::size_t used = 0;
+};
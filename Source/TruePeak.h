@@ -0,0 +1,290 @@
+#pragma once
+
+#include "../JUCE/modules/juce_dsp/juce_dsp.h"
+#include "StateArena.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+//==============================================================================
+// Intersample (true) peak estimator: 4x polyphase FIR interpolation as in
+// ITU-R BS.1770. The prototype is a 47-tap Kaiser-windowed sinc centred on tap
+// 23, so phase 3 is a pure delay of 5 samples (read straight from the history)
+// and only phases 0-2 are filtered: 12 taps each, vectorised across the block
+// one tap at a time with FloatVectorOperations.
+//
+// Output n is the largest magnitude in (n - 6, n - 5]: the sample x[n - 5] and
+// the three interpolated points before it. Sines up to 0.45 fs read at most
+// 0.45 dB under their true peak (0.03 dB below 0.1 fs), like any 4x meter.
+//
+// The history and scratch are carved from the owner's StateArena in prepare().
+class TruePeakInterpolator
+{
+public:
+    static constexpr int oversampling = 4;
+    static constexpr int tapsPerPhase = 12;
+    static constexpr int delaySamples = 5; // Input samples between x[n] and the pure-delay phase
+
+    TruePeakInterpolator()
+    {
+        constexpr int numTaps = oversampling * tapsPerPhase - 1;
+        constexpr int centre = numTaps / 2;
+
+        std::array<float, numTaps> window {};
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), window.size(),
+                                                                juce::dsp::WindowingFunction<float>::kaiser, false, 6.0f);
+
+        for (int phase = 0; phase < numFilteredPhases; ++phase) {
+            float sum = 0.0f;
+
+            for (int tap = 0; tap < tapsPerPhase; ++tap) {
+                const int j = phase + oversampling * tap;
+                const double t = static_cast<double>(j - centre) / oversampling;
+                const double sinc = t == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+
+                coefficients[phase][tap] = j < numTaps ? static_cast<float>(sinc) * window[static_cast<size_t>(j)] : 0.0f;
+                sum += coefficients[phase][tap];
+            }
+
+            // Unity DC gain per phase
+            for (auto& c : coefficients[phase])
+                c /= sum;
+        }
+    }
+
+    // Arena bytes prepare() carves: the channel lines, then the two block scratches
+    static std::size_t getStateBytes(int numChannels, int maxBlockSize)
+    {
+        return StateArena::bytesFor<float>(static_cast<std::size_t>(numChannels * (historyLength + maxBlockSize)))
+             + 2 * StateArena::bytesFor<float>(static_cast<std::size_t>(maxBlockSize));
+    }
+
+    void prepare(int newNumChannels, int newMaxBlockSize, StateArena& arena)
+    {
+        numChannels = newNumChannels;
+        maxBlockSize = newMaxBlockSize;
+        lines = arena.create<float>(static_cast<size_t>(numChannels * getLineLength()));
+        accumulator = arena.create<float>(static_cast<size_t>(maxBlockSize));
+        peaks = arena.create<float>(static_cast<size_t>(maxBlockSize));
+    }
+
+    void reset()
+    {
+        std::fill_n(lines, numChannels * getLineLength(), 0.0f);
+    }
+
+    // Per-sample true-peak magnitudes of one channel's next numSamples (<= the
+    // prepared block size); valid until the next call
+    const float* process(int channel, const float* input, int numSamples)
+    {
+        jassert(numSamples <= maxBlockSize);
+
+        float* line = lines + channel * getLineLength();
+        float* current = line + historyLength; // x[n] for n = 0 .. numSamples-1
+        juce::FloatVectorOperations::copy(current, input, numSamples);
+
+        // Pure-delay phase
+        juce::FloatVectorOperations::abs(peaks, current - delaySamples, numSamples);
+
+        for (int phase = 0; phase < numFilteredPhases; ++phase) {
+            juce::FloatVectorOperations::clear(accumulator, numSamples);
+
+            for (int tap = 0; tap < tapsPerPhase; ++tap)
+                juce::FloatVectorOperations::addWithMultiply(accumulator, current - tap, coefficients[phase][tap], numSamples);
+
+            juce::FloatVectorOperations::abs(accumulator, accumulator, numSamples);
+            juce::FloatVectorOperations::max(peaks, peaks, accumulator, numSamples);
+        }
+
+        // Keep the newest samples as history for the next call
+        std::copy(line + numSamples, line + numSamples + historyLength, line);
+        return peaks;
+    }
+
+private:
+    static constexpr int numFilteredPhases = oversampling - 1;
+    static constexpr int historyLength = tapsPerPhase - 1;
+
+    int getLineLength() const { return historyLength + maxBlockSize; }
+
+    std::array<std::array<float, tapsPerPhase>, numFilteredPhases> coefficients {};
+    float* lines = nullptr; // Per channel: history, then the current block (in the owner's arena)
+    float* accumulator = nullptr;
+    float* peaks = nullptr;
+    int numChannels = 0;
+    int maxBlockSize = 0;
+};
+
+//==============================================================================
+// Channel-linked lookahead limiter against the TruePeakInterpolator estimate.
+// Per sample, the gain that brings the loudest channel's true peak down to the
+// ceiling is min-held over lookahead + plateau samples, released exponentially
+// and smoothed by a lookahead-long moving average. The audio is delayed so
+// that the smoothed gain reaches each peak's gain a few samples before it and
+// holds it for the whole plateau. That covers the interpolation neighbourhood,
+// so the gain ramp itself cannot push a neighbouring sample back over the
+// ceiling. The output therefore meets the ceiling as the 4x estimate reads it;
+// an ideal reconstruction of content near Nyquist can still be up to its
+// under-read (about 0.5 dB) higher. Latency is fixed per sample rate (32 samples
+// at 48 kHz). Like the interpolator, its rings live in the owner's StateArena.
+class TruePeakLimiter
+{
+public:
+    static constexpr double lookaheadSeconds = 0.0005; // Attack ramp
+    static constexpr double releaseSeconds = 0.05;
+    static constexpr int plateauSamples = 8;
+
+    static int getLookahead(double sampleRate) { return std::max(4, juce::roundToInt(sampleRate * lookaheadSeconds)); }
+    static int getAudioDelay(int lookahead)    { return TruePeakInterpolator::delaySamples + lookahead - 1 + plateauSamples / 2; }
+
+    // Arena bytes prepare() carves: the interpolator, the block scratches, the rings, the delay lines
+    static std::size_t getStateBytes(double sampleRate, int numChannels, int maxBlockSize)
+    {
+        const int lookaheadLength = getLookahead(sampleRate);
+
+        return TruePeakInterpolator::getStateBytes(numChannels, maxBlockSize)
+             + 2 * StateArena::bytesFor<float>(static_cast<std::size_t>(maxBlockSize))
+             + StateArena::bytesFor<float>(static_cast<std::size_t>(lookaheadLength + plateauSamples))
+             + StateArena::bytesFor<float>(static_cast<std::size_t>(lookaheadLength))
+             + StateArena::bytesFor<float>(static_cast<std::size_t>(numChannels * getAudioDelay(lookaheadLength)));
+    }
+
+    void prepare(double sampleRate, int numChannels, int maxBlockSize, StateArena& arena)
+    {
+        lookahead = getLookahead(sampleRate);
+        holdLength = lookahead + plateauSamples;
+        audioDelay = getAudioDelay(lookahead);
+        releaseAlpha = 1.0f - static_cast<float>(std::exp(-1.0 / (releaseSeconds * sampleRate)));
+
+        interpolator.prepare(numChannels, maxBlockSize, arena);
+        linkedPeak = arena.create<float>(static_cast<size_t>(maxBlockSize));
+        gain = arena.create<float>(static_cast<size_t>(maxBlockSize));
+        holdRing = arena.create<float>(static_cast<size_t>(holdLength));
+        averageRing = arena.create<float>(static_cast<size_t>(lookahead));
+        delayLines = arena.create<float>(static_cast<size_t>(numChannels * audioDelay));
+        numDelayChannels = numChannels;
+
+        reset();
+    }
+
+    void reset()
+    {
+        interpolator.reset();
+        std::fill_n(holdRing, holdLength, 1.0f);
+        std::fill_n(averageRing, lookahead, 1.0f);
+        std::fill_n(delayLines, numDelayChannels * audioDelay, 0.0f);
+        holdPosition = averagePosition = delayPosition = 0;
+        heldGain = 1.0f;
+        heldAge = 0;
+        releasedGain = 1.0f;
+        averageSum = static_cast<double>(lookahead);
+    }
+
+    int getLatencySamples() const { return audioDelay; }
+
+    // Delays the block by getLatencySamples() and, with limit set, applies the
+    // linked gain that keeps its true peak at or under ceiling. Runs the detection
+    // either way so switching limiting on starts from current history.
+    template<typename Block>
+    void process(Block& block, float ceiling, bool limit)
+    {
+        const int numSamples = static_cast<int>(block.getNumSamples());
+        const int channels = std::min(numDelayChannels, static_cast<int>(block.getNumChannels()));
+
+        for (int ch = 0; ch < channels; ++ch) {
+            const float* peaks = interpolator.process(ch, block.getChannelPointer(static_cast<size_t>(ch)), numSamples);
+
+            if (ch == 0)
+                juce::FloatVectorOperations::copy(linkedPeak, peaks, numSamples);
+            else
+                juce::FloatVectorOperations::max(linkedPeak, linkedPeak, peaks, numSamples);
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+            gain[i] = nextGain(linkedPeak[i] > ceiling ? ceiling / linkedPeak[i] : 1.0f);
+
+        for (int ch = 0; ch < channels; ++ch) {
+            auto* data = block.getChannelPointer(static_cast<size_t>(ch));
+            float* line = delayLines + ch * audioDelay;
+            int position = delayPosition;
+
+            for (int i = 0; i < numSamples; ++i) {
+                const float delayed = line[position];
+                line[position] = data[i];
+                data[i] = limit ? delayed * gain[i] : delayed;
+
+                if (++position == audioDelay)
+                    position = 0;
+            }
+        }
+
+        delayPosition = (delayPosition + numSamples) % audioDelay;
+    }
+
+private:
+    float nextGain(float required)
+    {
+        // Sliding minimum over holdLength: rescan only when the held minimum expires
+        holdRing[holdPosition] = required;
+        if (++holdPosition == holdLength)
+            holdPosition = 0;
+
+        if (required <= heldGain) {
+            heldGain = required;
+            heldAge = 0;
+        } else if (++heldAge >= holdLength) {
+            rescanHold();
+        }
+
+        // Instant attack, exponential release (never above the held gain)
+        releasedGain = std::min(heldGain, releasedGain + (1.0f - releasedGain) * releaseAlpha);
+
+        // Moving average; the sum is rebuilt once per lap so rounding never accumulates
+        averageSum += releasedGain - averageRing[averagePosition];
+        averageRing[averagePosition] = releasedGain;
+
+        if (++averagePosition == lookahead) {
+            averagePosition = 0;
+            averageSum = 0.0;
+            for (int i = 0; i < lookahead; ++i)
+                averageSum += averageRing[i];
+        }
+
+        return static_cast<float>(averageSum / lookahead);
+    }
+
+    void rescanHold()
+    {
+        heldGain = 1.0f;
+        heldAge = 0;
+
+        // Oldest entry first, so ties keep the newest (longest-lived) minimum
+        for (int age = holdLength - 1; age >= 0; --age) {
+            const int index = (holdPosition - 1 - age + 2 * holdLength) % holdLength;
+
+            if (holdRing[index] <= heldGain) {
+                heldGain = holdRing[index];
+                heldAge = age;
+            }
+        }
+    }
+
+    TruePeakInterpolator interpolator;
+    float* linkedPeak = nullptr;   // Block scratch, all in the owner's arena
+    float* gain = nullptr;
+    float* holdRing = nullptr;
+    float* averageRing = nullptr;
+    float* delayLines = nullptr;   // numChannels x audioDelay rings
+
+    int lookahead = 24;
+    int holdLength = 32;
+    int audioDelay = 32;
+    int numDelayChannels = 0;
+    float releaseAlpha = 0.0f;
+
+    int holdPosition = 0, averagePosition = 0, delayPosition = 0;
+    float heldGain = 1.0f;
+    int heldAge = 0;
+    float releasedGain = 1.0f;
+    double averageSum = 24.0;
+};
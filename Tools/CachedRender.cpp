@@ -0,0 +1,207 @@
+#include "../Source/PluginProcessor.h"
+#include "../Source/DetectorCache.h"
+#include "../Source/PresetBank.h"
+
+//==============================================================================
+// Offline multi-preset render from one decoded input. The detector envelope is
+// analysed once per file into <input>.atakenv (reused while the file is unchanged)
+// and every parameter set renders in parallel against the shared mapping.
+//
+// Usage: AtakAtakCachedRender <input audio> <output dir> [--live] [preset.atakpreset ...]
+//   No preset files: renders every factory preset.
+//   --live: run the detector in every render instead of the cache (for A/B timing).
+
+namespace
+{
+    constexpr int renderBlockSize = 512;
+
+    struct RenderJob
+    {
+        juce::String name;
+        juce::MemoryBlock state;  // user preset chunk, or empty for a factory program
+        int program = -1;
+        std::unique_ptr<AtakAtakAudioProcessor> processor;
+    };
+
+    bool render (RenderJob& job, const juce::AudioBuffer<float>& source, double sampleRate,
+                 const DetectorEnvelopeCache* cache, const juce::File& outputFile)
+    {
+        auto& processor = *job.processor;
+        const int numChannels = source.getNumChannels();
+        const int length = source.getNumSamples();
+
+        processor.setNonRealtime (true);
+        processor.prepareToPlay (sampleRate, renderBlockSize);
+        processor.setCachedDetectorEnvelope (cache);
+
+        // Render latency extra samples and drop them from the front of the file
+        const int latency = processor.getLatencySamples();
+
+        juce::AudioBuffer<float> output (numChannels, length + latency);
+        output.clear();
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            output.copyFrom (ch, 0, source, ch, 0, length);
+
+        juce::MidiBuffer midi;
+
+        for (int start = 0; start < output.getNumSamples(); start += renderBlockSize)
+        {
+            const int n = juce::jmin (renderBlockSize, output.getNumSamples() - start);
+            juce::AudioBuffer<float> block (output.getArrayOfWritePointers(), numChannels, start, n);
+
+            processor.processBlock (block, midi);
+            midi.clear();
+        }
+
+        processor.releaseResources();
+
+        outputFile.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream (outputFile.createOutputStream());
+
+        if (stream == nullptr)
+            return false;
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream.get(), sampleRate,
+                                                                              (unsigned int) numChannels, 24, {}, 0));
+        if (writer == nullptr)
+            return false;
+
+        stream.release(); // owned by the writer now
+        return writer->writeFromAudioSampleBuffer (output, latency, length);
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    if (argc < 3)
+    {
+        std::cout << "Usage: AtakAtakCachedRender <input audio> <output dir> [--live] [preset.atakpreset ...]" << std::endl;
+        return 1;
+    }
+
+    const auto cwd = juce::File::getCurrentWorkingDirectory();
+    const auto inputFile = cwd.getChildFile (argv[1]);
+    const auto outputDir = cwd.getChildFile (argv[2]);
+
+    bool liveDetection = false;
+    juce::Array<juce::File> presetFiles;
+
+    for (int i = 3; i < argc; ++i)
+    {
+        if (juce::String (argv[i]) == "--live")
+            liveDetection = true;
+        else
+            presetFiles.add (cwd.getChildFile (argv[i]));
+    }
+
+    // Decode once
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (inputFile));
+
+    if (reader == nullptr)
+    {
+        std::cout << "Cannot read " << inputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    const double sampleRate = reader->sampleRate;
+    const int numChannels = juce::jlimit (1, 2, (int) reader->numChannels);
+    const int length = (int) reader->lengthInSamples;
+
+    juce::AudioBuffer<float> source (numChannels, length);
+    reader->read (&source, 0, length, 0, true, numChannels > 1);
+    reader.reset();
+
+    // Detector envelope: map the cache, analysing the file first if it is missing or stale
+    DetectorEnvelopeCache cache;
+
+    if (! liveDetection)
+    {
+        const auto cacheFile = DetectorEnvelopeCache::getCacheFileFor (inputFile);
+        const auto sourceId = DetectorEnvelopeCache::getSourceId (inputFile);
+
+        if (! cache.open (cacheFile, sampleRate, sourceId))
+        {
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+
+            if (! DetectorEnvelopeCache::create (cacheFile, source, sampleRate, sourceId)
+                || ! cache.open (cacheFile, sampleRate, sourceId))
+            {
+                std::cout << "Cannot write detector cache " << cacheFile.getFullPathName() << std::endl;
+                return 1;
+            }
+
+            std::cout << "Analysed detector envelope in "
+                      << juce::String (juce::Time::getMillisecondCounterHiRes() - start, 1) << " ms" << std::endl;
+        }
+    }
+
+    // Parameter sets. Processors are built here on the main thread; only rendering is parallel.
+    std::vector<RenderJob> jobs;
+
+    // Factory programs only: their indices are fixed, while user presets exist only in a
+    // bank that has finished its scan (render those by passing the preset files)
+    if (presetFiles.isEmpty())
+    {
+        AtakAtakAudioProcessor probe;
+
+        for (int i = 0; i < probe.getNumFactoryPrograms(); ++i)
+            jobs.push_back ({ probe.getProgramName (i), {}, i, nullptr });
+    }
+
+    for (auto& file : presetFiles)
+    {
+        RenderJob job { file.getFileNameWithoutExtension(), {}, -1, nullptr };
+
+        if (file.loadFileAsData (job.state))
+            jobs.push_back (std::move (job));
+        else
+            std::cout << "Skipping unreadable preset " << file.getFullPathName() << std::endl;
+    }
+
+    for (auto& job : jobs)
+    {
+        job.processor = std::make_unique<AtakAtakAudioProcessor>();
+        job.processor->setPlayConfigDetails (numChannels, numChannels, sampleRate, renderBlockSize);
+
+        if (job.state.getSize() > 0)
+            job.processor->setStateInformation (job.state.getData(), (int) job.state.getSize());
+        else
+            job.processor->setCurrentProgram (job.program); // Swapped in on the first block
+    }
+
+    outputDir.createDirectory();
+
+    std::atomic<int> failures { 0 };
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        juce::ThreadPool pool (juce::SystemStats::getNumCpus());
+
+        for (auto& job : jobs)
+        {
+            const auto outputFile = outputDir.getChildFile (inputFile.getFileNameWithoutExtension() + "_"
+                                                            + juce::File::createLegalFileName (job.name) + ".wav");
+
+            pool.addJob ([&, outputFile, jobPtr = &job]
+            {
+                if (! render (*jobPtr, source, sampleRate, liveDetection ? nullptr : &cache, outputFile))
+                    ++failures;
+            });
+        }
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep (10);
+    }
+
+    std::cout << "Rendered " << (int) jobs.size() << " parameter sets in "
+              << juce::String (juce::Time::getMillisecondCounterHiRes() - start, 1) << " ms ("
+              << (liveDetection ? "live detection" : "cached detector") << ")" << std::endl;
+
+    return failures.load() == 0 ? 0 : 1;
+}